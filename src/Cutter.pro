@@ -345,7 +345,30 @@ SOURCES += \
     common/CrashHandler.cpp \
     common/BugReporting.cpp \
     common/HighDpiPixmap.cpp \
-    widgets/GraphGridLayout.cpp
+    widgets/GraphGridLayout.cpp \
+    common/ExportCodeTask.cpp \
+    common/BlockStatisticsEngine.cpp \
+    common/NavbarRasterTask.cpp \
+    common/EntropyTask.cpp \
+    common/EntropyMapProvider.cpp \
+    common/SectionEntropyTask.cpp \
+    common/SectionEntropyProvider.cpp \
+    common/AsyncSortFilterProxyModel.cpp \
+    common/TrigramIndex.cpp \
+    common/StringsTask.cpp \
+    common/StringScanner.cpp \
+    common/CompactTables.cpp \
+    common/CompletionIndex.cpp \
+    common/SearchTask.cpp \
+    common/PatternMatcher.cpp \
+    common/PatternSearchTask.cpp \
+    common/RefineSearchTask.cpp \
+    common/RefreshScheduler.cpp \
+    common/RefreshRanges.cpp \
+    common/StallDetector.cpp \
+    common/Parallel.cpp \
+    common/CorePool.cpp \
+    common/R2Process.cpp
 
 HEADERS  += \
     core/Cutter.h \
@@ -467,7 +490,29 @@ HEADERS  += \
     common/BugReporting.h \
     common/HighDpiPixmap.h \
     widgets/GraphLayout.h \
-    widgets/GraphGridLayout.h
+    widgets/GraphGridLayout.h \
+    common/ExportCodeTask.h \
+    common/BlockStatisticsEngine.h \
+    common/NavbarRasterTask.h \
+    common/EntropyTask.h \
+    common/EntropyMapProvider.h \
+    common/SectionEntropyTask.h \
+    common/SectionEntropyProvider.h \
+    common/AsyncSortFilterProxyModel.h \
+    common/TrigramIndex.h \
+    common/StringScanner.h \
+    common/CompactTables.h \
+    common/CompletionIndex.h \
+    common/SearchTask.h \
+    common/PatternMatcher.h \
+    common/PatternSearchTask.h \
+    common/RefineSearchTask.h \
+    common/RefreshScheduler.h \
+    common/RefreshRanges.h \
+    common/StallDetector.h \
+    common/Parallel.h \
+    common/CorePool.h \
+    common/R2Process.h
 
 FORMS    += \
     dialogs/AboutDialog.ui \
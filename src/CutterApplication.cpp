@@ -1,5 +1,6 @@
 #include "common/PythonManager.h"
 #include "common/CrashHandler.h"
+#include "common/StallDetector.h"
 #include "CutterApplication.h"
 #include "plugins/PluginManager.h"
 #include "CutterConfig.h"
@@ -117,6 +118,9 @@ CutterApplication::CutterApplication(int &argc, char **argv) : QApplication(argc
     Core()->setSettings();
     Config()->loadInitial();
 
+    // Reports when the UI does not respond, with the event or command it was stuck in
+    stallDetector = new StallDetector(this);
+
     bool analLevelSpecified = false;
     int analLevel = 0;
 
@@ -190,6 +194,12 @@ CutterApplication::~CutterApplication()
 #endif
 }
 
+bool CutterApplication::notify(QObject *receiver, QEvent *event)
+{
+    StallDetector::Scope stallScope(receiver, event);
+    return QApplication::notify(receiver, event);
+}
+
 bool CutterApplication::event(QEvent *e)
 {
     if (e->type() == QEvent::FileOpen) {
@@ -8,6 +8,8 @@
 
 #include "core/MainWindow.h"
 
+class StallDetector;
+
 
 class CutterApplication : public QApplication
 {
@@ -22,6 +24,8 @@ public:
         return mainWindow;
     }
 
+    bool notify(QObject *receiver, QEvent *event) override;
+
 protected:
     bool event(QEvent *e);
 
@@ -35,6 +39,7 @@ private:
 private:
     bool m_FileAlreadyDropped;
     MainWindow *mainWindow;
+    StallDetector *stallDetector;
 };
 
 
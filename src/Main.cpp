@@ -4,6 +4,10 @@
 #include "common/UpdateWorker.h"
 #include "CutterConfig.h"
 #include "common/CrashHandler.h"
+#include "common/EntropyTask.h"
+#include "common/TrigramIndex.h"
+#include "common/CompactTables.h"
+#include "common/CompletionIndex.h"
 
 /**
  * @brief Migrate Settings used before Cutter 1.8
@@ -32,6 +36,15 @@ int main(int argc, char *argv[])
 
     qRegisterMetaType<QList<StringDescription>>();
     qRegisterMetaType<QList<FunctionDescription>>();
+    qRegisterMetaType<QList<SearchDescription>>();
+    // Typedefs are recorded by name in the signatures of queued signals, like the navbar raster's
+    qRegisterMetaType<RVA>("RVA");
+    qRegisterMetaType<QVector<RVA>>("QVector<RVA>");
+    qRegisterMetaType<EntropyMap>();
+    qRegisterMetaType<TrigramIndex>();
+    qRegisterMetaType<StringTable>();
+    qRegisterMetaType<CompletionIndex>();
+    qRegisterMetaType<QVector<CompletionIndex::Match>>();
 
     QCoreApplication::setOrganizationName("RadareOrg");
     QCoreApplication::setApplicationName("Cutter");
@@ -1,10 +1,14 @@
 #include "core/Cutter.h"
 #include "common/AnalTask.h"
+#include "common/Configuration.h"
+#include "common/R2Process.h"
 #include "core/MainWindow.h"
 #include "dialogs/InitialOptionsDialog.h"
 #include <QJsonArray>
 #include <QDebug>
 #include <QCheckBox>
+#include <QJsonObject>
+#include <QTemporaryFile>
 
 AnalTask::AnalTask() :
     AsyncTask()
@@ -15,15 +19,10 @@ AnalTask::~AnalTask()
 {
 }
 
-void AnalTask::interrupt()
-{
-    AsyncTask::interrupt();
-    r_cons_singleton()->context->breaked = true;
-}
-
 void AnalTask::runTask()
 {
     log(tr("Loading the file..."));
+    setPhase(tr("Loading"));
     openFailed = false;
 
     int perms = R_PERM_RX;
@@ -65,6 +64,7 @@ void AnalTask::runTask()
 
     if (!options.pdbFile.isNull()) {
         log(tr("Loading PDB file..."));
+        setPhase(tr("Loading PDB file"));
         Core()->loadPDB(options.pdbFile);
     }
 
@@ -74,6 +74,7 @@ void AnalTask::runTask()
 
     if (!options.shellcode.isNull() && options.shellcode.size() / 2 > 0) {
         log(tr("Loading shellcode..."));
+        setPhase(tr("Loading shellcode"));
         Core()->cmd("wx " + options.shellcode);
     }
 
@@ -85,6 +86,7 @@ void AnalTask::runTask()
 
     if (!options.script.isNull()) {
         log(tr("Executing script..."));
+        setPhase(tr("Executing script"));
         Core()->loadScript(options.script);
     }
 
@@ -97,15 +99,136 @@ void AnalTask::runTask()
 
     if (!options.analCmd.empty()) {
         log(tr("Analyzing..."));
+        // Shellcode is only written into this core, the child process would not see it
+        if (Config()->getAnalysisOutOfProcess() && options.shellcode.isEmpty()
+                && analyzeOutOfProcess()) {
+            return;
+        }
+        // Each command is a phase, so the dialog shows how long each one took
+        setProgressUnit(tr("commands"));
+        int done = 0;
+        setProgress(done, static_cast<qint64>(options.analCmd.size()));
         for (const QString &cmd : options.analCmd) {
             if (isInterrupted()) {
                 return;
             }
             log("  " + tr("Running") + " " + cmd);
+            setPhase(cmd);
             Core()->cmd(cmd);
+            setProgress(++done, static_cast<qint64>(options.analCmd.size()));
         }
         log(tr("Analysis complete!"));
     } else {
         log(tr("Skipping Analysis."));
     }
 }
+
+/**
+ * @brief Run the analysis commands in a radare2 child process and import the results
+ *
+ * While it runs the core is not locked, so Cutter stays responsive, and a crash in the analysis
+ * only loses the analysis. The child opens the file with the same options and gets the
+ * analysis and assembler settings of this core, its functions, flags, references, hints and
+ * comments are then imported as a script.
+ * @return false if the child could not be started and the analysis should run in this core
+ */
+bool AnalTask::analyzeOutOfProcess()
+{
+    QStringList args = {
+        "-e", QStringLiteral("bin.demangle=%1").arg(options.demangle ? "true" : "false"),
+        "-e", QStringLiteral("io.va=%1").arg(options.useVA ? "true" : "false"),
+        "-e", "scr.color=0"
+    };
+    if (options.binLoadAddr != RVA_INVALID) {
+        args << "-B" << RAddressString(options.binLoadAddr);
+    }
+    if (options.mapAddr != RVA_INVALID) {
+        args << "-m" << RAddressString(options.mapAddr);
+    }
+    if (!options.loadBinInfo) {
+        args << "-n";
+    }
+    if (!options.forceBinPlugin.isEmpty()) {
+        args << "-F" << options.forceBinPlugin;
+    }
+    args << options.filename;
+
+    R2Process process;
+    if (!process.start(args)) {
+        log(tr("Could not start the analysis process, analyzing in Cutter: %1")
+            .arg(process.errorString()));
+        return false;
+    }
+    log(tr("Analyzing in a separate process..."));
+
+    // Everything is sent right away, the outputs are only waited for to show the progress
+    QJsonObject config = Core()->cmdj("ej").object();
+    for (auto it = config.constBegin(); it != config.constEnd(); ++it) {
+        QString value = it.value().toVariant().toString();
+        bool relevant = it.key().startsWith("anal.") || it.key().startsWith("asm.")
+                        || it.key() == "cfg.bigendian";
+        if (relevant && !value.contains('"')) {
+            process.send(QStringLiteral("\"e %1=%2\"").arg(it.key(), value));
+        }
+    }
+    if (!options.pdbFile.isNull()) {
+        process.send("idp " + CutterCore::sanitizeStringForCommand(options.pdbFile));
+    }
+    int analysisStart = process.pending();
+    for (const QString &cmd : options.analCmd) {
+        process.send(cmd);
+    }
+    static const QStringList exportCmds = { "f*", "afl*", "ax*", "ah*", "CC*" };
+    for (const QString &cmd : exportCmds) {
+        process.send(cmd);
+    }
+
+    auto interrupted = [this]() {
+        return isInterrupted();
+    };
+    auto fail = [this, &process]() {
+        if (!isInterrupted()) {
+            log(tr("The analysis process failed, the file stays unanalyzed: %1")
+                .arg(process.errorString()));
+        }
+        return true;
+    };
+    setPhase(tr("Loading in the analysis process"));
+    while (process.pending() > analysisStart) {
+        if (!process.receive(nullptr, interrupted)) {
+            return fail();
+        }
+    }
+
+    setProgressUnit(tr("commands"));
+    int done = 0;
+    setProgress(done, static_cast<qint64>(options.analCmd.size()));
+    for (const QString &cmd : options.analCmd) {
+        log("  " + tr("Running") + " " + cmd);
+        setPhase(cmd);
+        if (!process.receive(nullptr, interrupted)) {
+            return fail();
+        }
+        setProgress(++done, static_cast<qint64>(options.analCmd.size()));
+    }
+
+    log(tr("Importing the results..."));
+    setPhase(tr("Importing"));
+    QTemporaryFile script;
+    if (!script.open()) {
+        log(tr("Could not import the analysis: %1").arg(script.errorString()));
+        return true;
+    }
+    while (process.pending() > 0) {
+        QByteArray output;
+        if (!process.receive(&output, interrupted)) {
+            return fail();
+        }
+        script.write(output);
+        script.write("\n");
+    }
+    script.close();
+    Core()->loadScript(script.fileName());
+    log(tr("Analysis complete!"));
+    return true;
+}
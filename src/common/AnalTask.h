@@ -21,8 +21,6 @@ public:
 
     void setOptions(const InitialOptions &options)	{ this->options = options; }
 
-    void interrupt() override;
-
     bool getOpenFileFailed()	{ return openFailed; }
 
 protected:
@@ -34,6 +32,8 @@ signals:
 private:
     InitialOptions options;
 
+    bool analyzeOutOfProcess();
+
     bool openFailed = false;
 };
 
@@ -0,0 +1,494 @@
+#include "common/AsyncSortFilterProxyModel.h"
+#include "core/Cutter.h"
+
+#include <QTimer>
+
+#include <algorithm>
+#include <numeric>
+
+class AsyncSortFilterProxyModel::SortFilterTask : public AsyncTask
+{
+public:
+    SortFilterTask(Snapshot *snapshot, int rowCount, const QRegExp &filter, int sortColumn,
+                   Qt::SortOrder sortOrder)
+        : snapshot(snapshot),
+          rowCount(rowCount),
+          filter(filter),
+          sortColumn(sortColumn),
+          sortOrder(sortOrder)
+    {
+        // The view shows nothing useful until the rows are filtered and sorted again
+        setPriority(Priority::Interactive);
+    }
+
+    /**
+     * @brief Only check the candidates of index instead of all rows
+     */
+    void setIndex(const TrigramIndex &index)
+    {
+        this->index = index;
+        indexed = true;
+    }
+
+    QString getTitle() override
+    {
+        return AsyncSortFilterProxyModel::tr("Sorting and filtering");
+    }
+
+    QVector<int> proxyToSource;
+    bool completed = false;
+
+protected:
+    void runTask() override
+    {
+        QVector<int> rows;
+        if (filter.isEmpty()) {
+            rows.resize(rowCount);
+            std::iota(rows.begin(), rows.end(), 0);
+        } else {
+            QVector<int> candidates;
+            bool narrowed = indexed && index.candidates(filter, &candidates);
+            int count = narrowed ? candidates.size() : rowCount;
+            for (int i = 0; i < count; i++) {
+                if ((i & 0xfff) == 0 && isInterrupted()) {
+                    return;
+                }
+                int row = narrowed ? candidates[i] : i;
+                if (snapshot->filterAcceptsRow(row, filter)) {
+                    rows.append(row);
+                }
+            }
+        }
+
+        if (sortColumn >= 0) {
+            const Snapshot *s = snapshot.get();
+            int column = sortColumn;
+            if (sortOrder == Qt::AscendingOrder) {
+                std::stable_sort(rows.begin(), rows.end(), [s, column](int left, int right) {
+                    return s->lessThan(left, right, column);
+                });
+            } else {
+                std::stable_sort(rows.begin(), rows.end(), [s, column](int left, int right) {
+                    return s->lessThan(right, left, column);
+                });
+            }
+        }
+        if (isInterrupted()) {
+            return;
+        }
+
+        proxyToSource = rows;
+        completed = true;
+    }
+
+private:
+    std::unique_ptr<Snapshot> snapshot;
+    int rowCount;
+    QRegExp filter;
+    int sortColumn;
+    Qt::SortOrder sortOrder;
+    TrigramIndex index;
+    bool indexed = false;
+};
+
+class AsyncSortFilterProxyModel::IndexTask : public AsyncTask
+{
+public:
+    IndexTask(Snapshot *snapshot, int rowCount)
+        : snapshot(snapshot),
+          rowCount(rowCount)
+    {
+        // Filtering works without it, only later filter changes get faster
+        setPriority(Priority::Background);
+    }
+
+    QString getTitle() override
+    {
+        return AsyncSortFilterProxyModel::tr("Indexing for the filter");
+    }
+
+    TrigramIndex index;
+    bool completed = false;
+
+protected:
+    void runTask() override
+    {
+        for (int row = 0; row < rowCount; row++) {
+            if ((row & 0xfff) == 0 && isInterrupted()) {
+                return;
+            }
+            index.append(snapshot->filterText(row));
+        }
+        completed = true;
+    }
+
+private:
+    std::unique_ptr<Snapshot> snapshot;
+    int rowCount;
+};
+
+AsyncSortFilterProxyModel::AsyncSortFilterProxyModel(QObject *parent)
+    : QAbstractProxyModel(parent)
+{
+}
+
+AsyncSortFilterProxyModel::~AsyncSortFilterProxyModel()
+{
+    if (task) {
+        task->interrupt();
+    }
+    if (indexTask) {
+        indexTask->interrupt();
+    }
+}
+
+void AsyncSortFilterProxyModel::setSourceModel(QAbstractItemModel *newSourceModel)
+{
+    if (sourceModel()) {
+        disconnect(sourceModel(), nullptr, this, nullptr);
+    }
+
+    beginResetModel();
+    QAbstractProxyModel::setSourceModel(newSourceModel);
+    proxyToSource.clear();
+    sourceToProxy.clear();
+    endResetModel();
+
+    if (!newSourceModel) {
+        return;
+    }
+    connect(newSourceModel, &QAbstractItemModel::modelAboutToBeReset,
+            this, &AsyncSortFilterProxyModel::sourceModelAboutToBeReset);
+    connect(newSourceModel, &QAbstractItemModel::modelReset,
+            this, &AsyncSortFilterProxyModel::sourceModelReset);
+    // The permutation can not follow a foreign layout change, so treat it like a reset
+    connect(newSourceModel, &QAbstractItemModel::layoutAboutToBeChanged,
+            this, &AsyncSortFilterProxyModel::sourceModelAboutToBeReset);
+    connect(newSourceModel, &QAbstractItemModel::layoutChanged,
+            this, &AsyncSortFilterProxyModel::sourceModelReset);
+    connect(newSourceModel, &QAbstractItemModel::dataChanged,
+            this, &AsyncSortFilterProxyModel::sourceDataChanged);
+    connect(newSourceModel, &QAbstractItemModel::rowsInserted,
+            this, &AsyncSortFilterProxyModel::sourceRowsInserted);
+    connect(newSourceModel, &QAbstractItemModel::rowsRemoved,
+            this, &AsyncSortFilterProxyModel::sourceRowsRemoved);
+    connect(newSourceModel, &QAbstractItemModel::headerDataChanged,
+            this, &QAbstractItemModel::headerDataChanged);
+    invalidate();
+}
+
+QModelIndex AsyncSortFilterProxyModel::index(int row, int column, const QModelIndex &parent) const
+{
+    if (parent.isValid() || row < 0 || row >= proxyToSource.size()
+            || column < 0 || column >= columnCount()) {
+        return QModelIndex();
+    }
+    return createIndex(row, column);
+}
+
+QModelIndex AsyncSortFilterProxyModel::parent(const QModelIndex &) const
+{
+    return QModelIndex();
+}
+
+int AsyncSortFilterProxyModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : proxyToSource.size();
+}
+
+int AsyncSortFilterProxyModel::columnCount(const QModelIndex &parent) const
+{
+    if (parent.isValid() || !sourceModel()) {
+        return 0;
+    }
+    return sourceModel()->columnCount();
+}
+
+bool AsyncSortFilterProxyModel::hasChildren(const QModelIndex &parent) const
+{
+    return !parent.isValid() && !proxyToSource.isEmpty();
+}
+
+QModelIndex AsyncSortFilterProxyModel::mapToSource(const QModelIndex &proxyIndex) const
+{
+    if (!proxyIndex.isValid() || !sourceModel() || proxyIndex.row() >= proxyToSource.size()) {
+        return QModelIndex();
+    }
+    return sourceModel()->index(proxyToSource[proxyIndex.row()], proxyIndex.column());
+}
+
+QModelIndex AsyncSortFilterProxyModel::mapFromSource(const QModelIndex &sourceIndex) const
+{
+    if (!sourceIndex.isValid() || sourceIndex.row() >= sourceToProxy.size()) {
+        return QModelIndex();
+    }
+    int row = sourceToProxy[sourceIndex.row()];
+    if (row < 0) {
+        return QModelIndex();
+    }
+    return createIndex(row, sourceIndex.column());
+}
+
+void AsyncSortFilterProxyModel::sort(int column, Qt::SortOrder order)
+{
+    if (column == sortColumn && order == sortOrder) {
+        return;
+    }
+    sortColumn = column;
+    sortOrder = order;
+    invalidate();
+}
+
+void AsyncSortFilterProxyModel::setFilterCaseSensitivity(Qt::CaseSensitivity cs)
+{
+    if (filter.caseSensitivity() == cs) {
+        return;
+    }
+    filter.setCaseSensitivity(cs);
+    invalidate();
+}
+
+void AsyncSortFilterProxyModel::setFilterRegExp(const QRegExp &regExp)
+{
+    Qt::CaseSensitivity cs = filter.caseSensitivity();
+    filter = regExp;
+    filter.setCaseSensitivity(cs);
+    invalidate();
+}
+
+void AsyncSortFilterProxyModel::setFilterWildcard(const QString &pattern)
+{
+    setFilterRegExp(QRegExp(pattern, filter.caseSensitivity(), QRegExp::Wildcard));
+}
+
+void AsyncSortFilterProxyModel::invalidate()
+{
+    if (task) {
+        // The result would be outdated anyway
+        task->interrupt();
+        task.clear();
+    }
+    if (invalidateScheduled) {
+        return;
+    }
+    // Coalesce e.g. a source reset followed by a filter change into one computation
+    invalidateScheduled = true;
+    QTimer::singleShot(0, this, [this]() {
+        invalidateScheduled = false;
+        startTask();
+    });
+}
+
+void AsyncSortFilterProxyModel::startTask()
+{
+    if (!sourceModel()) {
+        return;
+    }
+    task = QSharedPointer<SortFilterTask>(new SortFilterTask(createSnapshot(),
+                                                             sourceModel()->rowCount(), filter,
+                                                             sortColumn, sortOrder));
+    task->setSupersedeKey(this, QStringLiteral("sortFilter"));
+    if (filterIndexValid) {
+        task->setIndex(filterIndex);
+    }
+    QWeakPointer<SortFilterTask> weakTask = task;
+    connect(task.data(), &AsyncTask::finished, this, [this, weakTask]() {
+        QSharedPointer<SortFilterTask> finishedTask = weakTask.toStrongRef();
+        if (finishedTask) {
+            taskFinished(finishedTask.data());
+        }
+    }, Qt::QueuedConnection);
+    Core()->getAsyncTaskManager()->start(task);
+
+    if (!filter.isEmpty() && !filterIndexValid && !indexTask) {
+        startIndexTask();
+    }
+}
+
+void AsyncSortFilterProxyModel::startIndexTask()
+{
+    indexTask = QSharedPointer<IndexTask>(new IndexTask(createSnapshot(),
+                                                        sourceModel()->rowCount()));
+    indexTask->setSupersedeKey(this, QStringLiteral("filterIndex"));
+    QWeakPointer<IndexTask> weakTask = indexTask;
+    connect(indexTask.data(), &AsyncTask::finished, this, [this, weakTask]() {
+        QSharedPointer<IndexTask> finishedTask = weakTask.toStrongRef();
+        if (finishedTask) {
+            indexTaskFinished(finishedTask.data());
+        }
+    }, Qt::QueuedConnection);
+    Core()->getAsyncTaskManager()->start(indexTask);
+}
+
+void AsyncSortFilterProxyModel::indexTaskFinished(IndexTask *finishedTask)
+{
+    if (finishedTask != indexTask.data()) {
+        // Discarded because the rows it indexed changed
+        return;
+    }
+    indexTask.clear();
+    if (!finishedTask->completed) {
+        return;
+    }
+    filterIndex = finishedTask->index;
+    int rowCount = sourceModel()->rowCount();
+    if (filterIndex.size() < rowCount) {
+        // Appended while the task was running
+        std::unique_ptr<Snapshot> snapshot(createSnapshot());
+        for (int sourceRow = filterIndex.size(); sourceRow < rowCount; sourceRow++) {
+            filterIndex.append(snapshot->filterText(sourceRow));
+        }
+    }
+    filterIndexValid = true;
+}
+
+void AsyncSortFilterProxyModel::discardFilterIndex()
+{
+    filterIndexValid = false;
+    filterIndex = TrigramIndex();
+    if (indexTask) {
+        indexTask->interrupt();
+        indexTask.clear();
+    }
+}
+
+void AsyncSortFilterProxyModel::taskFinished(SortFilterTask *finishedTask)
+{
+    if (finishedTask != task.data() || !finishedTask->completed) {
+        // Superseded or interrupted
+        return;
+    }
+    QVector<int> newProxyToSource = finishedTask->proxyToSource;
+    task.clear();
+
+    // The source must not have changed in between, otherwise a new task would be pending
+    QVector<int> newSourceToProxy(sourceModel()->rowCount(), -1);
+    for (int row = 0; row < newProxyToSource.size(); row++) {
+        newSourceToProxy[newProxyToSource[row]] = row;
+    }
+    QVector<int> oldToNewRow(proxyToSource.size());
+    for (int row = 0; row < proxyToSource.size(); row++) {
+        oldToNewRow[row] = newSourceToProxy.value(proxyToSource[row], -1);
+    }
+    changeLayout(newProxyToSource, oldToNewRow);
+    sourceToProxy = newSourceToProxy;
+    emit sortFilterFinished();
+}
+
+void AsyncSortFilterProxyModel::changeLayout(const QVector<int> &newProxyToSource,
+                                             const QVector<int> &oldToNewRow)
+{
+    emit layoutAboutToBeChanged();
+    const QModelIndexList persistent = persistentIndexList();
+    for (const QModelIndex &from : persistent) {
+        int row = oldToNewRow.value(from.row(), -1);
+        changePersistentIndex(from, row >= 0 ? createIndex(row, from.column()) : QModelIndex());
+    }
+    proxyToSource = newProxyToSource;
+    emit layoutChanged();
+}
+
+void AsyncSortFilterProxyModel::rebuildSourceToProxy()
+{
+    sourceToProxy.fill(-1, sourceModel() ? sourceModel()->rowCount() : 0);
+    for (int row = 0; row < proxyToSource.size(); row++) {
+        sourceToProxy[proxyToSource[row]] = row;
+    }
+}
+
+void AsyncSortFilterProxyModel::sourceModelAboutToBeReset()
+{
+    beginResetModel();
+}
+
+void AsyncSortFilterProxyModel::sourceModelReset()
+{
+    discardFilterIndex();
+    // Rows show up once they are filtered and sorted
+    proxyToSource.clear();
+    sourceToProxy.clear();
+    endResetModel();
+    invalidate();
+}
+
+void AsyncSortFilterProxyModel::sourceDataChanged(const QModelIndex &topLeft,
+                                                  const QModelIndex &bottomRight,
+                                                  const QVector<int> &roles)
+{
+    if (filterIndexValid) {
+        // e.g. a rename, update the index for the changed rows only
+        std::unique_ptr<Snapshot> snapshot(createSnapshot());
+        for (int sourceRow = topLeft.row(); sourceRow <= bottomRight.row(); sourceRow++) {
+            filterIndex.update(sourceRow, snapshot->filterText(sourceRow));
+        }
+    } else if (indexTask) {
+        // It may have indexed the old texts already, start over with the next computation
+        discardFilterIndex();
+    }
+    for (int sourceRow = topLeft.row(); sourceRow <= bottomRight.row(); sourceRow++) {
+        int row = sourceToProxy.value(sourceRow, -1);
+        if (row >= 0) {
+            emit dataChanged(index(row, topLeft.column()), index(row, bottomRight.column()), roles);
+        }
+    }
+    // Changed values may have moved rows or changed whether they pass the filter
+    invalidate();
+}
+
+void AsyncSortFilterProxyModel::sourceRowsInserted(const QModelIndex &parent, int first, int last)
+{
+    if (parent.isValid()) {
+        return;
+    }
+    if (last != sourceModel()->rowCount() - 1) {
+        // Ids would shift, index again once a filter needs it
+        discardFilterIndex();
+    } else if (filterIndexValid) {
+        std::unique_ptr<Snapshot> snapshot(createSnapshot());
+        for (int sourceRow = first; sourceRow <= last; sourceRow++) {
+            filterIndex.append(snapshot->filterText(sourceRow));
+        }
+    }
+    // A running index task adds appended rows once it is finished, e.g. while strings stream in
+
+    // Visible rows stay the same, new rows appear with the next result
+    int count = last - first + 1;
+    for (int &sourceRow : proxyToSource) {
+        if (sourceRow >= first) {
+            sourceRow += count;
+        }
+    }
+    rebuildSourceToProxy();
+    invalidate();
+}
+
+void AsyncSortFilterProxyModel::sourceRowsRemoved(const QModelIndex &parent, int first, int last)
+{
+    if (parent.isValid()) {
+        return;
+    }
+    if (filterIndexValid && last == filterIndex.size() - 1) {
+        filterIndex.truncate(first);
+    } else {
+        discardFilterIndex();
+    }
+
+    int count = last - first + 1;
+    QVector<int> newProxyToSource;
+    newProxyToSource.reserve(proxyToSource.size());
+    QVector<int> oldToNewRow(proxyToSource.size(), -1);
+    for (int row = 0; row < proxyToSource.size(); row++) {
+        int sourceRow = proxyToSource[row];
+        if (sourceRow >= first && sourceRow <= last) {
+            continue;
+        }
+        oldToNewRow[row] = newProxyToSource.size();
+        newProxyToSource.append(sourceRow > last ? sourceRow - count : sourceRow);
+    }
+    changeLayout(newProxyToSource, oldToNewRow);
+    rebuildSourceToProxy();
+    if (task) {
+        // Its snapshot still contains the removed rows
+        invalidate();
+    }
+}
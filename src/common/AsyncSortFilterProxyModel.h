@@ -0,0 +1,132 @@
+#ifndef ASYNCSORTFILTERPROXYMODEL_H
+#define ASYNCSORTFILTERPROXYMODEL_H
+
+#include "common/AsyncTask.h"
+#include "common/TrigramIndex.h"
+
+#include <QAbstractProxyModel>
+#include <QRegExp>
+#include <QVector>
+
+#include <memory>
+
+/**
+ * @brief Proxy for flat list models which filters and sorts in a background task
+ *
+ * Subclasses provide a Snapshot, a thread-safe copy of the source data (usually an implicitly
+ * shared container, so taking it is cheap), which is filtered and sorted on the task pool.
+ * A newer computation interrupts the previous one, and the resulting row permutation is
+ * swapped in at once as a layout change, keeping selection and current index where possible.
+ * Until then the previous permutation stays visible.
+ *
+ * Once a filter is set, a TrigramIndex of the filter texts is built in a separate background
+ * task, meanwhile filtering checks all rows. The index is then kept up to date with appended,
+ * removed and changed rows, so later filter queries only have to look at the candidate rows.
+ */
+class AsyncSortFilterProxyModel : public QAbstractProxyModel
+{
+    Q_OBJECT
+
+public:
+    class Snapshot
+    {
+    public:
+        virtual ~Snapshot() = default;
+
+        /**
+         * @brief The text the filter is matched against, also used to build the TrigramIndex
+         * Called from the worker thread, must not touch the source model.
+         */
+        virtual QString filterText(int row) const = 0;
+
+        /**
+         * @brief Called from the worker thread, must not touch the source model
+         * Only called for rows the index can not rule out.
+         */
+        virtual bool filterAcceptsRow(int row, const QRegExp &filter) const
+        {
+            return filterText(row).contains(filter);
+        }
+
+        /**
+         * @brief Called from the worker thread, must not touch the source model
+         */
+        virtual bool lessThan(int left, int right, int column) const = 0;
+    };
+
+    explicit AsyncSortFilterProxyModel(QObject *parent = nullptr);
+    ~AsyncSortFilterProxyModel() override;
+
+    void setSourceModel(QAbstractItemModel *sourceModel) override;
+
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex &index) const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    bool hasChildren(const QModelIndex &parent = QModelIndex()) const override;
+
+    QModelIndex mapToSource(const QModelIndex &proxyIndex) const override;
+    QModelIndex mapFromSource(const QModelIndex &sourceIndex) const override;
+
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+    const QRegExp &filterRegExp() const     { return filter; }
+    void setFilterCaseSensitivity(Qt::CaseSensitivity cs);
+
+public slots:
+    void setFilterRegExp(const QRegExp &regExp);
+    void setFilterWildcard(const QString &pattern);
+
+    /**
+     * @brief Filter and sort again, e.g. because the subclass' own filter criteria changed
+     */
+    void invalidate();
+
+signals:
+    /**
+     * @brief A new result of filtering and sorting has been applied
+     */
+    void sortFilterFinished();
+
+protected:
+    /**
+     * @brief Called on the UI thread to capture everything the worker needs
+     */
+    virtual Snapshot *createSnapshot() const = 0;
+
+private:
+    class SortFilterTask;
+    class IndexTask;
+
+    QVector<int> proxyToSource;
+    QVector<int> sourceToProxy;
+
+    QRegExp filter;
+    int sortColumn = -1;
+    Qt::SortOrder sortOrder = Qt::AscendingOrder;
+
+    QSharedPointer<SortFilterTask> task;
+    bool invalidateScheduled = false;
+
+    TrigramIndex filterIndex;
+    bool filterIndexValid = false;
+    QSharedPointer<IndexTask> indexTask;
+
+    void startTask();
+    void taskFinished(SortFilterTask *finishedTask);
+    void startIndexTask();
+    void indexTaskFinished(IndexTask *finishedTask);
+    void discardFilterIndex();
+    void changeLayout(const QVector<int> &newProxyToSource, const QVector<int> &oldToNewRow);
+    void rebuildSourceToProxy();
+
+private slots:
+    void sourceModelAboutToBeReset();
+    void sourceModelReset();
+    void sourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight,
+                           const QVector<int> &roles);
+    void sourceRowsInserted(const QModelIndex &parent, int first, int last);
+    void sourceRowsRemoved(const QModelIndex &parent, int first, int last);
+};
+
+#endif // ASYNCSORTFILTERPROXYMODEL_H
@@ -1,6 +1,34 @@
 
 #include "AsyncTask.h"
 
+#include <QThread>
+
+// progressChanged() is emitted at most this often, in milliseconds
+static const qint64 progressSignalInterval = 100;
+
+static thread_local AsyncTask *currentTask = nullptr;
+
+AsyncTask::BreakScope::BreakScope(const std::function<void()> &breakFunction)
+    : task(AsyncTask::current())
+{
+    if (!task) {
+        return;
+    }
+    QMutexLocker locker(&task->breakMutex);
+    previous = task->breakFunction;
+    task->breakFunction = breakFunction;
+}
+
+AsyncTask::BreakScope::~BreakScope()
+{
+    if (!task) {
+        return;
+    }
+    // Once this returns, the function is not called anymore
+    QMutexLocker locker(&task->breakMutex);
+    task->breakFunction = previous;
+}
+
 AsyncTask::AsyncTask()
     : QObject(nullptr),
       QRunnable()
@@ -29,9 +57,29 @@ bool AsyncTask::wait(int timeout)
     return r;
 }
 
+AsyncTask *AsyncTask::current()
+{
+    return currentTask;
+}
+
 void AsyncTask::interrupt()
 {
     interrupted = true;
+    QMutexLocker locker(&breakMutex);
+    if (breakFunction) {
+        breakFunction();
+    }
+}
+
+void AsyncTask::setSupersedeKey(const void *owner, const QString &name)
+{
+    keyOwner = owner;
+    keyName = name;
+}
+
+bool AsyncTask::supersedes(const AsyncTask &other)
+{
+    return !keyName.isEmpty() && keyOwner == other.keyOwner && keyName == other.keyName;
 }
 
 void AsyncTask::prepareRun()
@@ -49,7 +97,21 @@ void AsyncTask::run()
 
     logBuffer.clear();
     emit logChanged(logBuffer);
+    progressDone = progressTotal = 0;
+    progressSignalTimer.invalidate();
+    progressSignalPending = false;
+    {
+        QMutexLocker locker(&phaseMutex);
+        phases.clear();
+        phaseStartDone = 0;
+    }
+    currentTask = this;
     runTask();
+    currentTask = nullptr;
+    endPhase();
+    if (progressSignalPending) {
+        emit progressChanged(progressDone, progressTotal);
+    }
 
     running = false;
 
@@ -64,18 +126,128 @@ void AsyncTask::log(QString s)
     emit logChanged(logBuffer);
 }
 
+void AsyncTask::setProgress(qint64 done, qint64 total)
+{
+    progressDone = done;
+    progressTotal = total;
+    {
+        QMutexLocker locker(&phaseMutex);
+        if (done < phaseStartDone) {
+            // Counting started again for the phase
+            phaseStartDone = 0;
+        }
+    }
+    // The last update always gets through, so the end of the work is shown
+    if (progressSignalTimer.isValid() && progressSignalTimer.elapsed() < progressSignalInterval
+            && done < total) {
+        progressSignalPending = true;
+        return;
+    }
+    progressSignalTimer.start();
+    progressSignalPending = false;
+    emit progressChanged(done, total);
+}
+
+void AsyncTask::setPhase(const QString &name)
+{
+    endPhase();
+    {
+        QMutexLocker locker(&phaseMutex);
+        phases.append(Phase { name, 0, 0 });
+        phaseTimer.start();
+        phaseStartDone = progressDone;
+    }
+    emit phaseChanged(name);
+}
+
+void AsyncTask::endPhase()
+{
+    QMutexLocker locker(&phaseMutex);
+    if (phases.isEmpty() || !phaseTimer.isValid()) {
+        return;
+    }
+    phases.last().elapsed = phaseTimer.elapsed();
+    phases.last().done = progressDone - phaseStartDone;
+    phaseTimer.invalidate();
+}
+
+QString AsyncTask::getPhase()
+{
+    QMutexLocker locker(&phaseMutex);
+    return phases.isEmpty() ? QString() : phases.last().name;
+}
+
+QList<AsyncTask::Phase> AsyncTask::getPhases()
+{
+    QMutexLocker locker(&phaseMutex);
+    QList<Phase> ret = phases;
+    if (!ret.isEmpty() && phaseTimer.isValid()) {
+        ret.last().elapsed = phaseTimer.elapsed();
+        ret.last().done = progressDone - phaseStartDone;
+    }
+    return ret;
+}
+
+double AsyncTask::getRate()
+{
+    qint64 elapsed;
+    qint64 done;
+    {
+        QMutexLocker locker(&phaseMutex);
+        // Without phases the whole task is one
+        elapsed = phaseTimer.isValid() ? phaseTimer.elapsed() : getElapsedTime();
+        done = progressDone - (phaseTimer.isValid() ? phaseStartDone : 0);
+    }
+    if (elapsed <= 0 || done <= 0) {
+        return 0.0;
+    }
+    return done * 1000.0 / elapsed;
+}
+
+qint64 AsyncTask::getRemainingTime()
+{
+    double rate = getRate();
+    qint64 remaining = progressTotal - progressDone;
+    if (rate <= 0.0 || progressTotal <= 0 || remaining < 0) {
+        return -1;
+    }
+    return static_cast<qint64>(remaining * 1000.0 / rate);
+}
+
 AsyncTaskManager::AsyncTaskManager(QObject *parent)
     : QObject(parent)
 {
     threadPool = new QThreadPool(this);
+    backgroundThreadPool = new QThreadPool(this);
+    // One core is left to the interactive tasks and the UI
+    backgroundThreadPool->setMaxThreadCount(qMax(1, QThread::idealThreadCount() - 1));
 }
 
 AsyncTaskManager::~AsyncTaskManager()
 {
 }
 
+void AsyncTaskManager::supersede(const AsyncTask::Ptr &task)
+{
+    // Copied, since dropping a task removes it from the list
+    const QList<AsyncTask::Ptr> current = tasks;
+    for (const AsyncTask::Ptr &other : current) {
+        if (other == task || !task->supersedes(*other)) {
+            continue;
+        }
+        other->interrupt();
+        QThreadPool *pool = other->getPriority() == AsyncTask::Priority::Background
+                            ? backgroundThreadPool : threadPool;
+        if (pool->tryTake(other.data())) {
+            // It never runs, but whoever waits for it still learns that it ended
+            emit other->finished();
+        }
+    }
+}
+
 void AsyncTaskManager::start(AsyncTask::Ptr task)
 {
+    supersede(task);
     tasks.append(task);
     task->prepareRun();
 
@@ -84,11 +256,20 @@ void AsyncTaskManager::start(AsyncTask::Ptr task)
         tasks.removeOne(weakPtr);
         emit tasksChanged();
     });
-    threadPool->start(task.data());
+    if (task->getPriority() == AsyncTask::Priority::Background) {
+        backgroundThreadPool->start(task.data());
+    } else {
+        threadPool->start(task.data(), static_cast<int>(task->getPriority()));
+    }
     emit tasksChanged();
 }
 
 bool AsyncTaskManager::getTasksRunning()
 {
-    return !tasks.isEmpty();
+    for (const AsyncTask::Ptr &task : tasks) {
+        if (task->getPriority() != AsyncTask::Priority::Background) {
+            return true;
+        }
+    }
+    return false;
 }
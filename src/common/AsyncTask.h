@@ -9,6 +9,8 @@
 #include <QSharedPointer>
 #include <QList>
 
+#include <functional>
+
 class AsyncTaskManager;
 
 class AsyncTask : public QObject, public QRunnable
@@ -20,9 +22,47 @@ class AsyncTask : public QObject, public QRunnable
 public:
     using Ptr = QSharedPointer<AsyncTask>;
 
+    /**
+     * @brief Order in which queued tasks are started
+     * Background tasks compute things nobody waits for yet and run in their own threads,
+     * so they never delay the other tasks.
+     */
+    enum class Priority { Background, Normal, Interactive };
+
+    /**
+     * @brief A named step of a task, see setPhase()
+     */
+    struct Phase {
+        QString name;
+        qint64 elapsed; //!< Milliseconds spent in the phase
+        qint64 done;    //!< Progress units completed during the phase
+    };
+
+    /**
+     * @brief Registers a function stopping what the task running in this thread waits for
+     * While the scope exists, interrupting the task calls the function, so a long r2 command
+     * ends early instead of the interruption only taking effect after it. Outside of tasks
+     * it does nothing.
+     */
+    class BreakScope
+    {
+    public:
+        explicit BreakScope(const std::function<void()> &breakFunction);
+        ~BreakScope();
+
+    private:
+        AsyncTask *task;
+        std::function<void()> previous;
+    };
+
     AsyncTask();
     ~AsyncTask();
 
+    /**
+     * @brief The task running in the calling thread, nullptr outside of tasks
+     */
+    static AsyncTask *current();
+
     void run() override final;
 
     void wait();
@@ -32,19 +72,71 @@ public:
     bool isRunning()                    { return running; }
 
     const QString &getLog()             { return logBuffer; }
+    qint64 getProgressDone()            { return progressDone; }
+    qint64 getProgressTotal()           { return progressTotal; }
     const QElapsedTimer &getTimer()     { return timer; }
     qint64 getElapsedTime()             { return timer.isValid() ? timer.elapsed() : 0; }
+    const QString &getProgressUnit()    { return progressUnit; }
+
+    QString getPhase();
+
+    /**
+     * @brief All phases so far, the last one still running if the task is
+     */
+    QList<Phase> getPhases();
+
+    /**
+     * @brief Progress units per second in the current phase
+     */
+    double getRate();
+
+    /**
+     * @brief Milliseconds until the progress reaches the total at the current rate, -1 if unknown
+     */
+    qint64 getRemainingTime();
 
     virtual QString getTitle()          { return QString(); }
 
+    Priority getPriority()              { return priority; }
+    void setPriority(Priority priority) { this->priority = priority; }
+
+    /**
+     * @brief Let this task supersede earlier tasks with the same owner and name
+     * When it is started, those still queued are dropped and those running are interrupted.
+     * @param owner usually the object starting the task, so instances of a widget stay independent
+     */
+    void setSupersedeKey(const void *owner, const QString &name);
+    bool supersedes(const AsyncTask &other);
+
 protected:
     virtual void runTask() =0;
 
     void log(QString s);
 
+    /**
+     * @brief Report numeric progress of the task
+     * A total of 0 means the amount of work is unknown. It can be called for every unit of
+     * work, progressChanged() is only emitted a few times per second.
+     */
+    void setProgress(qint64 done, qint64 total);
+
+    /**
+     * @brief Name of what progress is counted in, like "bytes", in plural
+     */
+    void setProgressUnit(const QString &unit)   { progressUnit = unit; }
+
+    /**
+     * @brief End the current phase and start a new one
+     * The time and progress of each phase are kept for a breakdown of the task, the rate
+     * and remaining time only consider the current one.
+     */
+    void setPhase(const QString &name);
+
 signals:
     void finished();
     void logChanged(const QString &log);
+    void progressChanged(qint64 done, qint64 total);
+    void phaseChanged(const QString &phase);
 
 private:
     bool running;
@@ -53,6 +145,25 @@ private:
 
     QElapsedTimer timer;
     QString logBuffer;
+    qint64 progressDone = 0;
+    qint64 progressTotal = 0;
+    QString progressUnit;
+    QElapsedTimer progressSignalTimer;
+    bool progressSignalPending = false;
+
+    QMutex phaseMutex;
+    QList<Phase> phases;
+    QElapsedTimer phaseTimer;
+    qint64 phaseStartDone = 0;
+
+    void endPhase();
+
+    QMutex breakMutex;
+    std::function<void()> breakFunction;
+
+    Priority priority = Priority::Normal;
+    const void *keyOwner = nullptr;
+    QString keyName;
 
     void prepareRun();
 };
@@ -63,13 +174,20 @@ class AsyncTaskManager : public QObject
 
 private:
     QThreadPool *threadPool;
+    QThreadPool *backgroundThreadPool;
     QList<AsyncTask::Ptr> tasks;
 
+    void supersede(const AsyncTask::Ptr &task);
+
 public:
     explicit AsyncTaskManager(QObject *parent = nullptr);
     ~AsyncTaskManager();
 
     void start(AsyncTask::Ptr task);
+
+    /**
+     * @brief Whether any task which is not a background task is queued or running
+     */
     bool getTasksRunning();
 
 signals:
@@ -0,0 +1,277 @@
+#include "common/BlockStatisticsEngine.h"
+
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QTimer>
+
+BlockStatisticsEngine::BlockStatisticsEngine(QObject *parent)
+    : QObject(parent)
+{
+    connect(Core(), &CutterCore::refreshAll, this, &BlockStatisticsEngine::invalidate);
+}
+
+void BlockStatisticsEngine::invalidate()
+{
+    dirty = true;
+    if (rebuildScheduled) {
+        return;
+    }
+    // Coalesce several invalidations in a row into one rebuild
+    rebuildScheduled = true;
+    QTimer::singleShot(0, this, [this]() {
+        rebuildScheduled = false;
+        if (dirty) {
+            rebuild();
+            emit statisticsChanged();
+        }
+    });
+}
+
+int BlockStatisticsEngine::bucketIndex(RVA addr) const
+{
+    if (addr < from || addr >= to) {
+        return -1;
+    }
+    return static_cast<int>((addr - from) / bucketSize);
+}
+
+void BlockStatisticsEngine::addFunction(RVA addr, RVA size, int sign)
+{
+    int first = bucketIndex(addr);
+    if (first < 0) {
+        return;
+    }
+    buckets[first].functions += sign;
+    int last = size ? bucketIndex(qMin(addr + size, to) - 1) : first;
+    for (int i = first; i <= last; i++) {
+        buckets[i].inFunctions += sign;
+    }
+}
+
+void BlockStatisticsEngine::setFlagCount(RVA addr, int count)
+{
+    int old = flagCounts.value(addr, 0);
+    if (count) {
+        flagCounts[addr] = count;
+    } else {
+        flagCounts.remove(addr);
+    }
+    int i = bucketIndex(addr);
+    if (i >= 0) {
+        buckets[i].flags += count - old;
+    }
+}
+
+void BlockStatisticsEngine::setComment(RVA addr, bool exists)
+{
+    if (commentAddrs.contains(addr) == exists) {
+        return;
+    }
+    if (exists) {
+        commentAddrs.insert(addr);
+    } else {
+        commentAddrs.remove(addr);
+    }
+    int i = bucketIndex(addr);
+    if (i >= 0) {
+        buckets[i].comments += exists ? 1 : -1;
+    }
+}
+
+void BlockStatisticsEngine::updateFunctionAt(RVA addr)
+{
+    if (dirty) {
+        // Everything will be recomputed anyway
+        return;
+    }
+
+    RVA size = 0;
+    bool exists;
+    {
+        RCoreLocked core = Core()->core();
+        RAnalFunction *fcn = r_anal_get_fcn_at(core->anal, addr, R_ANAL_FCN_TYPE_NULL);
+        exists = fcn != nullptr;
+        if (fcn) {
+            size = r_anal_fcn_size(fcn);
+        }
+    }
+
+    auto it = functionSizes.find(addr);
+    if (it != functionSizes.end()) {
+        addFunction(addr, it.value(), -1);
+        functionSizes.erase(it);
+    }
+    if (exists) {
+        functionSizes[addr] = size;
+        addFunction(addr, size, 1);
+    }
+
+    emit statisticsChanged();
+}
+
+void BlockStatisticsEngine::updateFlagsAt(RVA addr)
+{
+    if (dirty) {
+        return;
+    }
+
+    int count;
+    {
+        RCoreLocked core = Core()->core();
+        const RList *flags = r_flag_get_list(core->flags, addr);
+        count = flags ? r_list_length(flags) : 0;
+    }
+    setFlagCount(addr, count);
+
+    emit statisticsChanged();
+}
+
+void BlockStatisticsEngine::updateCommentAt(RVA addr)
+{
+    if (dirty) {
+        return;
+    }
+
+    bool exists;
+    {
+        RCoreLocked core = Core()->core();
+        exists = r_meta_get_string(core->anal, R_META_TYPE_COMMENT, addr) != nullptr;
+    }
+    setComment(addr, exists);
+
+    emit statisticsChanged();
+}
+
+void BlockStatisticsEngine::rebuild()
+{
+    dirty = false;
+    functionSizes.clear();
+    flagCounts.clear();
+    commentAddrs.clear();
+
+    RCoreLocked core = Core()->core();
+    RListIter *it;
+
+    // The address space covered is the union hull of all sections, like p- does
+    RList *sections = core->bin ? r_bin_get_sections(core->bin) : nullptr;
+    from = RVA_INVALID;
+    to = 0;
+    RBinSection *section;
+    CutterRListForeach(sections, it, RBinSection, section) {
+        if (!section->vsize) {
+            continue;
+        }
+        from = qMin(from, section->vaddr);
+        to = qMax(to, section->vaddr + section->vsize);
+    }
+    if (from >= to) {
+        from = 0;
+        to = r_io_size(core->io);
+    }
+
+    buckets.clear();
+    if (from >= to) {
+        return;
+    }
+    bucketSize = qMax<RVA>(1, (to - from + bucketCount - 1) / bucketCount);
+    buckets.resize(static_cast<int>((to - from + bucketSize - 1) / bucketSize));
+
+    CutterRListForeach(sections, it, RBinSection, section) {
+        if (!section->vsize) {
+            continue;
+        }
+        ut8 rwx = 0;
+        if (section->perm & R_PERM_R) {
+            rwx |= (1 << 0);
+        }
+        if (section->perm & R_PERM_W) {
+            rwx |= (1 << 1);
+        }
+        if (section->perm & R_PERM_X) {
+            rwx |= (1 << 2);
+        }
+        int first = bucketIndex(section->vaddr);
+        int last = bucketIndex(section->vaddr + section->vsize - 1);
+        for (int i = first; i >= 0 && i <= last; i++) {
+            buckets[i].rwx |= rwx;
+        }
+    }
+
+    RAnalFunction *fcn;
+    CutterRListForeach(core->anal->fcns, it, RAnalFunction, fcn) {
+        RVA size = r_anal_fcn_size(fcn);
+        functionSizes[fcn->addr] = size;
+        addFunction(fcn->addr, size, 1);
+    }
+
+    r_flag_foreach(core->flags, [](RFlagItem *fi, void *user) -> bool {
+        auto *engine = static_cast<BlockStatisticsEngine *>(user);
+        engine->setFlagCount(fi->offset, engine->flagCounts.value(fi->offset, 0) + 1);
+        return true;
+    }, this);
+
+    for (const QJsonValue &value : Core()->cmdj("CCj").array()) {
+        setComment(value.toObject()["offset"].toVariant().toULongLong(), true);
+    }
+
+    if (core->bin && core->bin->cur && core->bin->cur->o) {
+        RBinSymbol *symbol;
+        CutterRListForeach(core->bin->cur->o->symbols, it, RBinSymbol, symbol) {
+            int i = bucketIndex(symbol->vaddr);
+            if (i >= 0) {
+                buckets[i].symbols++;
+            }
+        }
+    }
+
+    RList *strings = core->bin ? r_bin_get_strings(core->bin) : nullptr;
+    RBinString *string;
+    CutterRListForeach(strings, it, RBinString, string) {
+        int i = bucketIndex(string->vaddr);
+        if (i >= 0) {
+            buckets[i].strings++;
+        }
+    }
+}
+
+BlockStatistics BlockStatisticsEngine::getStatistics(unsigned int blocksCount)
+{
+    if (dirty) {
+        rebuild();
+    }
+
+    BlockStatistics ret;
+    ret.from = from;
+    ret.to = to;
+    ret.blocksize = 0;
+    if (blocksCount == 0 || buckets.isEmpty()) {
+        ret.from = ret.to = 0;
+        return ret;
+    }
+
+    // Each block covers a whole number of fine buckets, so no bucket is counted twice
+    int n = buckets.size();
+    int count = static_cast<int>(qMin<unsigned int>(blocksCount, static_cast<unsigned int>(n)));
+    ret.blocksize = (to - from + count - 1) / count;
+    for (int b = 0; b < count; b++) {
+        int first = static_cast<int>(static_cast<qint64>(b) * n / count);
+        int last = static_cast<int>(static_cast<qint64>(b + 1) * n / count);
+
+        BlockDescription block = {};
+        block.addr = from + first * bucketSize;
+        block.size = qMin(to, from + last * bucketSize) - block.addr;
+        for (int i = first; i < last; i++) {
+            const Bucket &bucket = buckets[i];
+            block.functions += bucket.functions;
+            // A function spanning several buckets must only be counted once
+            block.inFunctions = qMax(block.inFunctions, bucket.inFunctions);
+            block.flags += bucket.flags;
+            block.comments += bucket.comments;
+            block.symbols += bucket.symbols;
+            block.strings += bucket.strings;
+            block.rwx |= bucket.rwx;
+        }
+        ret.blocks << block;
+    }
+    return ret;
+}
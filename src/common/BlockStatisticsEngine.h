@@ -0,0 +1,92 @@
+#ifndef BLOCKSTATISTICSENGINE_H
+#define BLOCKSTATISTICSENGINE_H
+
+#include "core/Cutter.h"
+
+#include <QObject>
+#include <QVector>
+#include <QMap>
+#include <QSet>
+
+/**
+ * @brief Maintains per-address-bucket counts of functions, comments, strings, symbols and flags
+ *
+ * The whole mapped address space is divided into a fixed number of fine buckets. Functions
+ * are kept as intervals and flags and comments as per-address counts, so single additions,
+ * removals and resizes only touch the buckets they cover instead of recomputing everything
+ * through r2. getStatistics() resamples the fine buckets to any number of blocks without
+ * querying r2.
+ *
+ * Whoever changes functions, flags or comments calls the update method for the address, or
+ * invalidate() when it does not know where. A full rebuild also happens on refreshAll.
+ */
+class BlockStatisticsEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    static const int bucketCount = 1 << 16;
+
+    explicit BlockStatisticsEngine(QObject *parent = nullptr);
+
+    /**
+     * @return statistics for the whole address space resampled to blocksCount blocks
+     */
+    BlockStatistics getStatistics(unsigned int blocksCount);
+
+    /**
+     * @brief Re-read the function at addr from r2 and update the counts accordingly
+     * Call after creating, deleting or resizing a function.
+     */
+    void updateFunctionAt(RVA addr);
+
+    /**
+     * @brief Re-read the number of flags at addr from r2 and update the counts accordingly
+     */
+    void updateFlagsAt(RVA addr);
+
+    /**
+     * @brief Re-read whether there is a comment at addr from r2 and update the counts accordingly
+     */
+    void updateCommentAt(RVA addr);
+
+public slots:
+    /**
+     * @brief Mark the statistics as stale, they will be rebuilt on the next event loop iteration
+     */
+    void invalidate();
+
+signals:
+    void statisticsChanged();
+
+private:
+    struct Bucket {
+        int functions = 0;
+        int inFunctions = 0;
+        int flags = 0;
+        int comments = 0;
+        int symbols = 0;
+        int strings = 0;
+        ut8 rwx = 0;
+    };
+
+    RVA from = 0;
+    RVA to = 0;
+    RVA bucketSize = 1;
+    QVector<Bucket> buckets;
+
+    QMap<RVA, RVA> functionSizes;
+    QMap<RVA, int> flagCounts;
+    QSet<RVA> commentAddrs;
+
+    bool dirty = true;
+    bool rebuildScheduled = false;
+
+    void rebuild();
+    int bucketIndex(RVA addr) const;
+    void addFunction(RVA addr, RVA size, int sign);
+    void setFlagCount(RVA addr, int count);
+    void setComment(RVA addr, bool exists);
+};
+
+#endif // BLOCKSTATISTICSENGINE_H
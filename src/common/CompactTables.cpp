@@ -0,0 +1,261 @@
+#include "common/CompactTables.h"
+
+#include <algorithm>
+#include <cstring>
+
+quint32 NamePool::intern(const QString &name)
+{
+    auto it = ids.constFind(name);
+    if (it != ids.constEnd()) {
+        return it.value();
+    }
+    auto id = static_cast<quint32>(names.size());
+    names.append(name);
+    ids.insert(name, id);
+    return id;
+}
+
+TextColumn::TextColumn()
+{
+    offsets.append(0);
+}
+
+void TextColumn::append(const QString &text)
+{
+    blob += text.toUtf8();
+    offsets.append(static_cast<quint32>(blob.size()));
+}
+
+void TextColumn::append(const char *utf8, int size)
+{
+    blob.append(utf8, size);
+    offsets.append(static_cast<quint32>(blob.size()));
+}
+
+void TextColumn::append(const TextColumn &other)
+{
+    auto base = static_cast<quint32>(blob.size());
+    blob += other.blob;
+    offsets.reserve(offsets.size() + other.size());
+    for (int i = 1; i < other.offsets.size(); i++) {
+        offsets.append(base + other.offsets[i]);
+    }
+}
+
+QString TextColumn::at(int row) const
+{
+    quint32 start = offsets[row];
+    return QString::fromUtf8(blob.constData() + start, static_cast<int>(offsets[row + 1] - start));
+}
+
+int TextColumn::compare(const TextColumn &leftColumn, int left, const TextColumn &rightColumn,
+                        int right, Qt::CaseSensitivity cs)
+{
+    quint32 leftStart = leftColumn.offsets[left];
+    quint32 leftSize = leftColumn.offsets[left + 1] - leftStart;
+    quint32 rightStart = rightColumn.offsets[right];
+    quint32 rightSize = rightColumn.offsets[right + 1] - rightStart;
+    auto leftData = reinterpret_cast<const uchar *>(leftColumn.blob.constData() + leftStart);
+    auto rightData = reinterpret_cast<const uchar *>(rightColumn.blob.constData() + rightStart);
+    quint32 size = qMin(leftSize, rightSize);
+
+    if (cs == Qt::CaseInsensitive) {
+        quint32 i = 0;
+        for (; i < size; i++) {
+            uchar l = leftData[i];
+            uchar r = rightData[i];
+            if ((l | r) & 0x80) {
+                // Only texts with non-ASCII characters are decoded, to be folded like QString does
+                int ret = QString::compare(leftColumn.at(left), rightColumn.at(right),
+                                           Qt::CaseInsensitive);
+                if (ret != 0) {
+                    return ret;
+                }
+                break;
+            }
+            if (l != r) {
+                l = (l >= 'A' && l <= 'Z') ? l + ('a' - 'A') : l;
+                r = (r >= 'A' && r <= 'Z') ? r + ('a' - 'A') : r;
+                if (l != r) {
+                    return l < r ? -1 : 1;
+                }
+            }
+        }
+        if (i == size && leftSize != rightSize) {
+            return leftSize < rightSize ? -1 : 1;
+        }
+        // Equal except for case, fall back to code points for a stable order
+    }
+
+    // Bytewise order of UTF-8 is the order of the code points
+    int ret = memcmp(leftData, rightData, size);
+    if (ret != 0) {
+        return ret;
+    }
+    return leftSize < rightSize ? -1 : (leftSize > rightSize ? 1 : 0);
+}
+
+void TextColumn::clear()
+{
+    blob.clear();
+    offsets.clear();
+    offsets.append(0);
+}
+
+void TextColumn::squeeze()
+{
+    blob.squeeze();
+    offsets.squeeze();
+}
+
+
+StringDescription StringTable::Row::toDescription() const
+{
+    StringDescription str;
+    str.vaddr = vaddr();
+    str.string = string();
+    str.type = type();
+    str.section = section();
+    str.length = length();
+    str.size = size();
+    return str;
+}
+
+int StringTable::chunkOf(int row) const
+{
+    auto it = std::upper_bound(chunkStarts.constBegin(), chunkStarts.constEnd(), row);
+    return static_cast<int>(it - chunkStarts.constBegin()) - 1;
+}
+
+StringTable::Row StringTable::at(int row) const
+{
+    int chunk = chunkOf(row);
+    return Row(chunks[chunk].constData(), row - chunkStarts[chunk]);
+}
+
+void StringTable::append(const StringDescription &str)
+{
+    QByteArray utf8 = str.string.toUtf8();
+    append(str.vaddr, utf8.constData(), utf8.size(), str.type, str.section, str.length, str.size);
+}
+
+void StringTable::append(RVA vaddr, const char *utf8, int utf8Size, const QString &type,
+                         const QString &section, ut32 length, ut32 size)
+{
+    if (chunks.isEmpty()) {
+        chunks.append(QSharedDataPointer<Chunk>(new Chunk));
+        chunkStarts.append(0);
+    }
+    // Only copies the last chunk if it is shared, searches fill tables nobody else sees yet
+    Chunk *chunk = chunks.last().data();
+    chunk->vaddrs.append(vaddr);
+    chunk->strings.append(utf8, utf8Size);
+    chunk->types.append(chunk->names.intern(type));
+    chunk->sections.append(chunk->names.intern(section));
+    chunk->lengths.append(length);
+    chunk->sizes.append(size);
+    rows++;
+}
+
+void StringTable::append(const StringTable &other)
+{
+    for (int i = 0; i < other.chunks.size(); i++) {
+        chunks.append(other.chunks[i]);
+        chunkStarts.append(rows + other.chunkStarts[i]);
+    }
+    rows += other.rows;
+}
+
+int StringTable::compareStrings(int left, int right, Qt::CaseSensitivity cs) const
+{
+    int leftChunk = chunkOf(left);
+    int rightChunk = chunkOf(right);
+    return TextColumn::compare(chunks[leftChunk]->strings, left - chunkStarts[leftChunk],
+                               chunks[rightChunk]->strings, right - chunkStarts[rightChunk], cs);
+}
+
+void StringTable::clear()
+{
+    chunks.clear();
+    chunkStarts.clear();
+    rows = 0;
+}
+
+void StringTable::squeeze()
+{
+    for (QSharedDataPointer<Chunk> &chunk : chunks) {
+        chunk->vaddrs.squeeze();
+        chunk->lengths.squeeze();
+        chunk->sizes.squeeze();
+        chunk->types.squeeze();
+        chunk->sections.squeeze();
+        chunk->strings.squeeze();
+    }
+}
+
+
+FlagDescription FlagTable::Row::toDescription() const
+{
+    FlagDescription flag;
+    flag.offset = offset();
+    flag.size = size();
+    flag.name = name();
+    return flag;
+}
+
+FlagTable::FlagTable()
+    : d(new Data)
+{
+}
+
+FlagTable::FlagTable(const QList<FlagDescription> &flags)
+    : d(new Data)
+{
+    d->offsets.reserve(flags.size());
+    d->sizes.reserve(flags.size());
+    for (const FlagDescription &flag : flags) {
+        append(flag);
+    }
+}
+
+void FlagTable::append(const FlagDescription &flag)
+{
+    d->offsets.append(flag.offset);
+    d->sizes.append(flag.size);
+    d->names.append(flag.name);
+}
+
+
+SymbolDescription SymbolTable::Row::toDescription() const
+{
+    SymbolDescription symbol;
+    symbol.vaddr = vaddr();
+    symbol.bind = bind();
+    symbol.type = type();
+    symbol.name = name();
+    return symbol;
+}
+
+SymbolTable::SymbolTable()
+    : d(new Data)
+{
+}
+
+SymbolTable::SymbolTable(const QList<SymbolDescription> &symbols)
+    : d(new Data)
+{
+    d->vaddrs.reserve(symbols.size());
+    d->binds.reserve(symbols.size());
+    d->types.reserve(symbols.size());
+    for (const SymbolDescription &symbol : symbols) {
+        append(symbol);
+    }
+}
+
+void SymbolTable::append(const SymbolDescription &symbol)
+{
+    d->vaddrs.append(symbol.vaddr);
+    d->binds.append(d->pool.intern(symbol.bind));
+    d->types.append(d->pool.intern(symbol.type));
+    d->names.append(symbol.name);
+}
@@ -0,0 +1,234 @@
+#ifndef COMPACTTABLES_H
+#define COMPACTTABLES_H
+
+#include "core/CutterDescriptions.h"
+
+#include <QByteArray>
+#include <QHash>
+#include <QSharedData>
+#include <QSharedDataPointer>
+#include <QVector>
+
+/**
+ * @file CompactTables.h
+ * Column-wise storage for the large lists shown in the Strings, Flags and Symbols widgets.
+ *
+ * A QList of descriptions allocates every entry and every QString separately, which adds up
+ * to hundreds of MB for a few 100k strings. The tables here keep one array per column, intern
+ * the few distinct values of columns like type or section and put all texts into one UTF-8
+ * blob. They are implicitly shared, so the task result, the widget and the snapshots of the
+ * proxy models all refer to the same data. Rows are read through lightweight accessors.
+ */
+
+/**
+ * @brief Interns the distinct values of low cardinality columns as ids
+ */
+class NamePool
+{
+public:
+    quint32 intern(const QString &name);
+    const QString &name(quint32 id) const   { return names.at(static_cast<int>(id)); }
+    int size() const                        { return names.size(); }
+
+private:
+    QVector<QString> names;
+    QHash<QString, quint32> ids;
+};
+
+/**
+ * @brief Column of texts stored back to back as UTF-8
+ */
+class TextColumn
+{
+public:
+    TextColumn();
+
+    int size() const                        { return offsets.size() - 1; }
+
+    void append(const QString &text);
+    void append(const char *utf8, int size);
+    void append(const TextColumn &other);
+    QString at(int row) const;
+
+    /**
+     * @brief Compare two rows by code points, without decoding them unless they contain
+     * non-ASCII characters and are compared case-insensitively
+     */
+    int compare(int left, int right, Qt::CaseSensitivity cs = Qt::CaseSensitive) const
+    {
+        return compare(*this, left, *this, right, cs);
+    }
+
+    /**
+     * @brief Like compare(), for rows of two columns
+     */
+    static int compare(const TextColumn &leftColumn, int left, const TextColumn &rightColumn,
+                       int right, Qt::CaseSensitivity cs);
+
+    void clear();
+    void squeeze();
+
+private:
+    QByteArray blob;
+    QVector<quint32> offsets;
+};
+
+/**
+ * @brief Strings found by a search, stored in chunks as they were appended
+ *
+ * Appending a table shares its chunks instead of copying the rows, so appending a batch of
+ * strings stays cheap while snapshots of the proxy model share the table.
+ */
+class StringTable
+{
+private:
+    struct Chunk : public QSharedData {
+        QVector<RVA> vaddrs;
+        QVector<ut32> lengths;
+        QVector<ut32> sizes;
+        QVector<quint32> types;
+        QVector<quint32> sections;
+        TextColumn strings;
+        NamePool names;
+    };
+
+public:
+    class Row
+    {
+    public:
+        RVA vaddr() const                   { return chunk->vaddrs[row]; }
+        QString string() const              { return chunk->strings.at(row); }
+        const QString &type() const         { return chunk->names.name(chunk->types[row]); }
+        const QString &section() const      { return chunk->names.name(chunk->sections[row]); }
+        ut32 length() const                 { return chunk->lengths[row]; }
+        ut32 size() const                   { return chunk->sizes[row]; }
+
+        StringDescription toDescription() const;
+
+    private:
+        friend class StringTable;
+        Row(const Chunk *chunk, int row) : chunk(chunk), row(row) {}
+
+        const Chunk *chunk;
+        int row;
+    };
+
+    int size() const                        { return rows; }
+    bool isEmpty() const                    { return rows == 0; }
+    Row at(int row) const;
+
+    void append(const StringDescription &str);
+    void append(RVA vaddr, const char *utf8, int utf8Size, const QString &type,
+                const QString &section, ut32 length, ut32 size);
+    void append(const StringTable &other);
+
+    int compareStrings(int left, int right, Qt::CaseSensitivity cs = Qt::CaseSensitive) const;
+
+    void clear();
+    void squeeze();
+
+private:
+    QVector<QSharedDataPointer<Chunk>> chunks;
+    /**
+     * First row of each chunk
+     */
+    QVector<int> chunkStarts;
+    int rows = 0;
+
+    int chunkOf(int row) const;
+};
+
+class FlagTable
+{
+public:
+    class Row
+    {
+    public:
+        RVA offset() const                  { return table->d->offsets[row]; }
+        RVA size() const                    { return table->d->sizes[row]; }
+        QString name() const                { return table->d->names.at(row); }
+
+        FlagDescription toDescription() const;
+
+    private:
+        friend class FlagTable;
+        Row(const FlagTable *table, int row) : table(table), row(row) {}
+
+        const FlagTable *table;
+        int row;
+    };
+
+    FlagTable();
+    explicit FlagTable(const QList<FlagDescription> &flags);
+
+    int size() const                        { return d->offsets.size(); }
+    bool isEmpty() const                    { return d->offsets.isEmpty(); }
+    Row at(int row) const                   { return Row(this, row); }
+
+    void append(const FlagDescription &flag);
+
+    int compareNames(int left, int right, Qt::CaseSensitivity cs = Qt::CaseSensitive) const
+    {
+        return d->names.compare(left, right, cs);
+    }
+
+private:
+    struct Data : public QSharedData {
+        QVector<RVA> offsets;
+        QVector<RVA> sizes;
+        TextColumn names;
+    };
+
+    QSharedDataPointer<Data> d;
+};
+
+class SymbolTable
+{
+public:
+    class Row
+    {
+    public:
+        RVA vaddr() const                   { return table->d->vaddrs[row]; }
+        const QString &bind() const         { return table->d->pool.name(table->d->binds[row]); }
+        const QString &type() const         { return table->d->pool.name(table->d->types[row]); }
+        QString name() const                { return table->d->names.at(row); }
+
+        SymbolDescription toDescription() const;
+
+    private:
+        friend class SymbolTable;
+        Row(const SymbolTable *table, int row) : table(table), row(row) {}
+
+        const SymbolTable *table;
+        int row;
+    };
+
+    SymbolTable();
+    explicit SymbolTable(const QList<SymbolDescription> &symbols);
+
+    int size() const                        { return d->vaddrs.size(); }
+    bool isEmpty() const                    { return d->vaddrs.isEmpty(); }
+    Row at(int row) const                   { return Row(this, row); }
+
+    void append(const SymbolDescription &symbol);
+
+    int compareNames(int left, int right, Qt::CaseSensitivity cs = Qt::CaseSensitive) const
+    {
+        return d->names.compare(left, right, cs);
+    }
+
+private:
+    struct Data : public QSharedData {
+        QVector<RVA> vaddrs;
+        QVector<quint32> binds;
+        QVector<quint32> types;
+        TextColumn names;
+        NamePool pool;
+    };
+
+    QSharedDataPointer<Data> d;
+};
+
+Q_DECLARE_METATYPE(StringTable)
+
+#endif // COMPACTTABLES_H
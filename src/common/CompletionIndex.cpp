@@ -0,0 +1,190 @@
+#include "common/CompletionIndex.h"
+#include "common/Parallel.h"
+#include "core/Cutter.h"
+
+#include <QSet>
+
+#include <algorithm>
+#include <numeric>
+
+// Prefix matches of short queries are only ranked among this many names in sorted order
+static const int maxPrefixCandidates = 10000;
+
+void CompletionIndex::append(const QString &text, Kind kind)
+{
+    texts.append(text);
+    kinds.append(kind);
+    names.append(text);
+}
+
+void CompletionIndex::finish()
+{
+    // Folded only for sorting, queries fold the few names they look at again
+    QVector<QString> folded(texts.size());
+    QString *out = folded.data();
+    Parallel::forChunks(texts.size(), 4096, [this, out](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            out[i] = texts[i].toCaseFolded();
+        }
+    });
+    prefixOrder.resize(texts.size());
+    std::iota(prefixOrder.begin(), prefixOrder.end(), 0);
+    const QString *sortKeys = folded.constData();
+    Parallel::sort(prefixOrder.begin(), prefixOrder.end(), [sortKeys](int a, int b) {
+        return sortKeys[a] < sortKeys[b];
+    });
+}
+
+QVector<CompletionIndex::Match> CompletionIndex::query(const QString &query, int limit,
+                                                       AsyncTask *task) const
+{
+    QVector<Match> ret;
+    QString folded = query.toCaseFolded();
+    if (folded.isEmpty() || limit <= 0) {
+        return ret;
+    }
+
+    struct Scored {
+        int rank;
+        int length;
+        int id;
+    };
+    QVector<Scored> scored;
+    auto score = [&](int id, const QString &name) {
+        int pos = name.indexOf(folded);
+        if (pos < 0) {
+            return;
+        }
+        int rank;
+        if (name.size() == folded.size()) {
+            rank = 0;
+        } else if (pos == 0) {
+            rank = 1;
+        } else if (!name[pos - 1].isLetterOrNumber()) {
+            rank = 2;
+        } else {
+            rank = 3;
+        }
+        scored.append(Scored { rank, name.size(), id });
+    };
+
+    QVector<int> candidates;
+    if (names.candidates(QRegExp(query, Qt::CaseInsensitive, QRegExp::FixedString), &candidates)) {
+        for (int i = 0; i < candidates.size(); i++) {
+            if ((i & 0xfff) == 0 && task && task->isInterrupted()) {
+                return ret;
+            }
+            score(candidates[i], texts[candidates[i]].toCaseFolded());
+        }
+    } else {
+        // Too short for trigrams, the sorted names still give all prefix matches
+        auto it = std::lower_bound(prefixOrder.constBegin(), prefixOrder.constEnd(), folded,
+        [this](int id, const QString &value) {
+            return texts[id].toCaseFolded() < value;
+        });
+        int first = static_cast<int>(it - prefixOrder.constBegin());
+        for (int i = first; i < prefixOrder.size() && i - first < maxPrefixCandidates; i++) {
+            QString name = texts[prefixOrder[i]].toCaseFolded();
+            if (!name.startsWith(folded)) {
+                break;
+            }
+            score(prefixOrder[i], name);
+        }
+    }
+
+    int count = qMin(limit, scored.size());
+    std::partial_sort(scored.begin(), scored.begin() + count, scored.end(),
+    [this](const Scored &a, const Scored &b) {
+        if (a.rank != b.rank) {
+            return a.rank < b.rank;
+        }
+        if (a.length != b.length) {
+            return a.length < b.length;
+        }
+        return texts[a.id] < texts[b.id];
+    });
+
+    QSet<int> used;
+    for (int i = 0; i < count; i++) {
+        ret.append(Match { texts[scored[i].id], kinds[scored[i].id] });
+        used.insert(scored[i].id);
+    }
+    if (ret.size() < limit) {
+        for (int id : names.similar(query, limit, [this](int id) { return texts[id].size(); })) {
+            if (ret.size() >= limit) {
+                break;
+            }
+            if (!used.contains(id)) {
+                ret.append(Match { texts[id], kinds[id] });
+            }
+        }
+    }
+    return ret;
+}
+
+CompletionIndexTask::CompletionIndexTask()
+{
+    // Queries keep using the previous index until this one is done
+    setPriority(Priority::Background);
+}
+
+void CompletionIndexTask::runTask()
+{
+    CompletionIndex index;
+    // Function names are usually flags as well, the first kind seen is kept
+    QSet<QString> added;
+    auto add = [&](const QString &name, CompletionIndex::Kind kind) {
+        if (!name.isEmpty() && !added.contains(name)) {
+            added.insert(name);
+            index.append(name, kind);
+        }
+    };
+
+    for (const FunctionDescription &function : Core()->getAllFunctions()) {
+        add(function.name, CompletionIndex::Kind::Function);
+    }
+    for (const QString &section : Core()->getSectionList()) {
+        add(section, CompletionIndex::Kind::Section);
+    }
+    if (isInterrupted()) {
+        return;
+    }
+    const QList<FlagDescription> flags = Core()->getAllFlags();
+    for (int i = 0; i < flags.size(); i++) {
+        if ((i & 0xfff) == 0 && isInterrupted()) {
+            return;
+        }
+        add(flags[i].name, CompletionIndex::Kind::Flag);
+    }
+    added.clear();
+
+    index.finish();
+    emit indexBuilt(index);
+}
+
+CompletionQueryTask::CompletionQueryTask(const CompletionIndex &index, const QString &query,
+                                         int limit, bool evaluate)
+    : index(index),
+      queryText(query),
+      limit(limit),
+      evaluate(evaluate)
+{
+    // The user is typing and waits for the result
+    setPriority(Priority::Interactive);
+}
+
+void CompletionQueryTask::runTask()
+{
+    QVector<CompletionIndex::Match> matches;
+    if (index.size() > 0) {
+        matches = index.query(queryText, limit, this);
+    }
+    if (isInterrupted()) {
+        return;
+    }
+    // Evaluating takes the core lock, which must not happen in the UI thread on every keystroke
+    RVA expressionValue = evaluate ? Core()->math(queryText) : RVA_INVALID;
+    if (!isInterrupted()) {
+        emit queryFinished(queryText, matches, expressionValue);
+    }
+}
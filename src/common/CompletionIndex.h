@@ -0,0 +1,111 @@
+#ifndef COMPLETIONINDEX_H
+#define COMPLETIONINDEX_H
+
+#include "common/AsyncTask.h"
+#include "common/TrigramIndex.h"
+#include "core/CutterCommon.h"
+
+#include <QMetaType>
+#include <QVector>
+
+/**
+ * @brief Names the Omnibar can complete, with a prefix and a trigram index for ranked lookups
+ *
+ * Queries return only the best matches, so neither the index nor the completer ever has to
+ * go through a list model of all names. Like TrigramIndex it is implicitly shared and can
+ * be handed to query tasks while a new one is being built.
+ */
+class CompletionIndex
+{
+public:
+    enum class Kind : quint8 { Flag, Function, Section, Expression };
+
+    struct Match {
+        QString text;
+        Kind kind;
+    };
+
+    void append(const QString &text, Kind kind);
+
+    /**
+     * @brief Sort the prefix index, must be called after the last append()
+     */
+    void finish();
+
+    int size() const                        { return texts.size(); }
+
+    /**
+     * @brief The up to limit best matches for query
+     * Exact matches come first, then prefix matches, matches at a word boundary and matches
+     * anywhere in the name, each ordered by length. If that does not fill the limit, names
+     * sharing most trigrams with the query are added for typos.
+     * @param task checked for interruption while going through candidates, may be null
+     */
+    QVector<Match> query(const QString &query, int limit, AsyncTask *task = nullptr) const;
+
+private:
+    QVector<QString> texts;
+    QVector<Kind> kinds;
+    TrigramIndex names;
+    /**
+     * Ids ordered by case folded name, so all names with a prefix are one range
+     */
+    QVector<int> prefixOrder;
+};
+
+/**
+ * @brief Collects flags, functions and sections and builds a CompletionIndex of them
+ */
+class CompletionIndexTask : public AsyncTask
+{
+    Q_OBJECT
+
+public:
+    CompletionIndexTask();
+
+    QString getTitle() override                     { return tr("Indexing names for completion"); }
+
+signals:
+    void indexBuilt(const CompletionIndex &index);
+
+protected:
+    void runTask() override;
+};
+
+/**
+ * @brief Runs one CompletionIndex::query() in the background
+ */
+class CompletionQueryTask : public AsyncTask
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @param evaluate also evaluate the query as an r2 expression, which needs the core lock
+     */
+    CompletionQueryTask(const CompletionIndex &index, const QString &query, int limit,
+                        bool evaluate);
+
+    QString getTitle() override                     { return tr("Completing"); }
+
+signals:
+    /**
+     * @param expressionValue value of the evaluated query, RVA_INVALID if it was not evaluated
+     */
+    void queryFinished(const QString &query, const QVector<CompletionIndex::Match> &matches,
+                       RVA expressionValue);
+
+protected:
+    void runTask() override;
+
+private:
+    CompletionIndex index;
+    QString queryText;
+    int limit;
+    bool evaluate;
+};
+
+Q_DECLARE_METATYPE(CompletionIndex)
+Q_DECLARE_METATYPE(CompletionIndex::Match)
+
+#endif // COMPLETIONINDEX_H
@@ -99,6 +99,34 @@ public:
         s.setValue("graph.maxcols", ch);
     }
 
+    /**
+     * @brief Milliseconds without another seek before the graph of a different function is loaded
+     */
+    int getGraphLoadDelay() const
+    {
+        return s.value("graph.loadDelay", 100).toInt();
+    }
+    void setGraphLoadDelay(int delay)
+    {
+        s.setValue("graph.loadDelay", delay);
+    }
+
+    /**
+     * @brief Milliseconds the UI thread may be blocked before StallDetector reports it, 0 to disable
+     */
+    int getStallThreshold() const     { return s.value("stall.threshold", 500).toInt(); }
+    bool getStallNotice() const       { return s.value("stall.notice", false).toBool(); }
+
+    /**
+     * @brief Number of secondary instances of the file CorePool reads through, 0 to disable
+     */
+    int getCorePoolSize() const       { return s.value("corePool.size", 4).toInt(); }
+
+    /**
+     * @brief Whether the initial analysis runs in a radare2 child process, see AnalTask
+     */
+    bool getAnalysisOutOfProcess() const { return s.value("analysis.outOfProcess", false).toBool(); }
+
     QString getColorTheme() const     { return s.value("theme", "cutter").toString(); }
     void setColorTheme(const QString &theme);
 
@@ -0,0 +1,189 @@
+#include "common/CorePool.h"
+#include "common/Configuration.h"
+#include "core/Cutter.h"
+
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonObject>
+
+#include <algorithm>
+
+CorePool::CorePool(QObject *parent)
+    : QObject(parent),
+      size(Config()->getCorePoolSize())
+{
+    connect(Core(), &CutterCore::refreshAll, this, &CorePool::updateMaps);
+    // From now on the main core may read edited bytes or the debuggee instead of the file
+    connect(Core(), &CutterCore::instructionChanged, this, &CorePool::invalidate);
+    connect(Core(), &CutterCore::changeDebugView, this, &CorePool::invalidate);
+}
+
+CorePool::~CorePool()
+{
+    clear();
+}
+
+void CorePool::open(const QString &path)
+{
+    clear();
+    RCoreLocked core = Core()->core();
+    RIODesc *desc = core->file && core->io->desc && core->file->fd == core->io->desc->fd
+                    ? core->io->desc : nullptr;
+    bool debug = desc && desc->plugin && desc->plugin->isdbg;
+    // Everything written to a writable file, from the UI, the console or scripts, would have
+    // to be tracked, and URIs like malloc:// open something else than the file in a new instance
+    bool writable = desc && (desc->perm & R_PERM_W);
+    bool file = !path.contains(QLatin1String("://")) && QFileInfo(path).isFile();
+    {
+        QMutexLocker locker(&mutex);
+        this->path = path;
+        mainIo = core->io;
+        valid = !debug && !writable && file && size > 0;
+    }
+    updateMaps();
+}
+
+void CorePool::clear()
+{
+    QMutexLocker locker(&mutex);
+    valid = false;
+    while (leased > 0) {
+        released.wait(&mutex);
+    }
+    for (RIO *io : idle) {
+        r_io_free(io);
+    }
+    idle.clear();
+    created = 0;
+    maps.clear();
+}
+
+void CorePool::invalidate()
+{
+    QMutexLocker locker(&mutex);
+    valid = false;
+}
+
+void CorePool::updateMaps()
+{
+    QVector<Map> fileMaps;
+    bool fileVa;
+    {
+        RCoreLocked core = Core()->core();
+        if (!core->file) {
+            return;
+        }
+        int fd = core->file->fd;
+        fileVa = r_config_get_i(core->config, "io.va");
+        for (const QJsonValue &value : Core()->cmdj("omj").array()) {
+            QJsonObject mapObject = value.toObject();
+            if (mapObject["fd"].toInt(-1) != fd) {
+                continue;
+            }
+            Map map;
+            map.from = mapObject["from"].toVariant().toULongLong();
+            map.to = mapObject["to"].toVariant().toULongLong() + 1;
+            map.delta = mapObject["delta"].toVariant().toULongLong();
+            if (map.to > map.from) {
+                fileMaps.append(map);
+            }
+        }
+    }
+    std::sort(fileMaps.begin(), fileMaps.end(), [](const Map &a, const Map &b) {
+        return a.from < b.from;
+    });
+
+    QMutexLocker locker(&mutex);
+    maps = fileMaps;
+    va = fileVa;
+}
+
+bool CorePool::translate(RVA addr, int len, ut64 *paddr) const
+{
+    if (!va) {
+        *paddr = addr;
+        return true;
+    }
+    // Only the main core knows which of overlapping maps is on top, leave those reads to it
+    int found = 0;
+    for (const Map &map : maps) {
+        if (map.from > addr) {
+            break;
+        }
+        if (addr < map.to) {
+            if (found++ || map.to - addr < static_cast<ut64>(len)) {
+                return false;
+            }
+            *paddr = addr - map.from + map.delta;
+        }
+    }
+    return found == 1;
+}
+
+RIO *CorePool::acquire()
+{
+    QString openPath;
+    {
+        QMutexLocker locker(&mutex);
+        if (!idle.isEmpty()) {
+            leased++;
+            return idle.takeLast();
+        }
+        if (created >= size) {
+            return nullptr;
+        }
+        created++;
+        leased++;
+        openPath = path;
+    }
+
+    // Opening the file takes a moment, do it without blocking the other readers
+    RIO *io = r_io_new();
+    if (io && !r_io_open_nomap(io, openPath.toUtf8().constData(), R_PERM_R, 0)) {
+        r_io_free(io);
+        io = nullptr;
+    }
+    if (!io) {
+        QMutexLocker locker(&mutex);
+        // Do not try again for every read
+        valid = false;
+        leased--;
+        released.wakeAll();
+    }
+    return io;
+}
+
+void CorePool::release(RIO *io)
+{
+    QMutexLocker locker(&mutex);
+    idle.append(io);
+    leased--;
+    released.wakeAll();
+}
+
+QByteArray CorePool::ioRead(RVA addr, int len, bool physical)
+{
+    if (len <= 0) {
+        return QByteArray();
+    }
+    ut64 paddr = addr;
+    bool usable;
+    {
+        QMutexLocker locker(&mutex);
+        // Read without the core lock, like currentlyDebugging, a stale value only costs one read.
+        // With io.cache, bytes written even to a read-only file are only in the main core.
+        usable = valid && !Core()->currentlyDebugging && !mainIo->cached
+                 && (physical || translate(addr, len, &paddr));
+    }
+    RIO *io = usable ? acquire() : nullptr;
+    if (!io) {
+        return Core()->ioRead(addr, len, physical);
+    }
+
+    QByteArray buf(len, 0);
+    if (r_io_pread_at(io, paddr, reinterpret_cast<ut8 *>(buf.data()), len) <= 0) {
+        buf.clear();
+    }
+    release(io);
+    return buf;
+}
@@ -0,0 +1,76 @@
+#ifndef COREPOOL_H
+#define COREPOOL_H
+
+#include "core/CutterCommon.h"
+
+#include <QMutex>
+#include <QObject>
+#include <QVector>
+#include <QWaitCondition>
+
+/**
+ * @brief Secondary read-only instances of the opened file, so tasks reading it do not wait for the core
+ *
+ * The main core is behind one lock, which analysis and long commands hold for a long time.
+ * Tasks which only read bytes, like string scans, searches, entropy and exports, read through
+ * an idle secondary instance instead, in parallel to each other and to the main core.
+ * Virtual addresses are translated with the maps of the main core, reads which are not
+ * completely inside one map of the file fall back to CutterCore::ioRead().
+ *
+ * The secondary instances are RIO only, not full RCores: creating an RCore rebinds the console
+ * of the process, which the main core uses for every command, so commands like decompiling
+ * still run in the main core. Once the main core may read something else than the file,
+ * because bytes were edited or a debug session started, the pool is not used until the next
+ * file is opened. It is not used at all for files opened writable or through URIs like
+ * malloc://, and not while io.cache is enabled.
+ *
+ * The number of instances is the setting "corePool.size", read at startup, 0 disables the pool.
+ */
+class CorePool : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit CorePool(QObject *parent = nullptr);
+    ~CorePool() override;
+
+    /**
+     * @brief Use the file the main core just opened, called with the core locked
+     */
+    void open(const QString &path);
+
+    /**
+     * @brief Like CutterCore::ioRead(), through a secondary instance if possible
+     */
+    QByteArray ioRead(RVA addr, int len, bool physical = false);
+
+private slots:
+    void updateMaps();
+    void invalidate();
+
+private:
+    struct Map {
+        RVA from;
+        RVA to;     //!< Exclusive
+        ut64 delta; //!< Offset in the file of from
+    };
+
+    const int size;
+    QMutex mutex;
+    QWaitCondition released;
+    QString path;
+    RIO *mainIo = nullptr;
+    bool valid = false;
+    bool va = true;
+    QVector<Map> maps;
+    QList<RIO *> idle;
+    int created = 0;
+    int leased = 0;
+
+    void clear();
+    bool translate(RVA addr, int len, ut64 *paddr) const;
+    RIO *acquire();
+    void release(RIO *io);
+};
+
+#endif // COREPOOL_H
@@ -0,0 +1,117 @@
+#include "common/EntropyMapProvider.h"
+
+#include <QFileInfo>
+#include <QDateTime>
+
+#include <algorithm>
+
+// Complete maps kept for files and patch states seen before
+static const int cachedMaps = 4;
+
+EntropyMapProvider::EntropyMapProvider(QObject *parent)
+    : QObject(parent),
+      cache(cachedMaps)
+{
+    connect(Core(), &CutterCore::refreshAll, this, &EntropyMapProvider::invalidate);
+    connect(Core(), &CutterCore::instructionChanged, this, &EntropyMapProvider::invalidate);
+}
+
+EntropyMapProvider::~EntropyMapProvider()
+{
+    if (task) {
+        task->interrupt();
+    }
+}
+
+QString EntropyMapProvider::fileKey()
+{
+    QString path = Core()->getConfig("file.path");
+    QFileInfo info(path);
+    QString key = QStringLiteral("%1:%2:%3:%4").arg(path)
+                  .arg(info.size())
+                  .arg(info.lastModified().toMSecsSinceEpoch())
+                  .arg(Core()->getPatchEpoch());
+    if (Core()->getConfigb("io.cache")) {
+        // Patches in the cache, e.g. from the console, do not go through CutterCore
+        key += QStringLiteral(":%1").arg(qHash(Core()->cmd("wc")));
+    }
+    return key;
+}
+
+QString EntropyMapProvider::currentKey(RVA from, RVA to) const
+{
+    return QStringLiteral("%1:%2:%3").arg(fileKey()).arg(from).arg(to);
+}
+
+void EntropyMapProvider::invalidate()
+{
+    if (mapKey.isNull()) {
+        // Nobody asked for the map yet
+        return;
+    }
+    mapKey.clear();
+    request();
+}
+
+void EntropyMapProvider::request()
+{
+    // Cover the same range as the navigation bar statistics
+    BlockStatistics range = Core()->getBlockStatistics(1);
+    QString key = currentKey(range.from, range.to);
+    if (key == mapKey) {
+        return;
+    }
+    mapKey = key;
+
+    if (task) {
+        task->interrupt();
+        task.clear();
+    }
+
+    if (const EntropyMap *cached = cache.object(key)) {
+        map = *cached;
+        emit mapChanged();
+        return;
+    }
+
+    map = EntropyMap();
+    emit mapChanged();
+    if (range.to <= range.from) {
+        return;
+    }
+
+    // Sections like the navigation bar statistics, or everything if there are none
+    QVector<QPair<RVA, RVA>> mapped;
+    for (const SectionDescription &section : Core()->getAllSections()) {
+        if (section.vsize) {
+            mapped.append({ section.vaddr, section.vaddr + section.vsize });
+        }
+    }
+    std::sort(mapped.begin(), mapped.end());
+    QVector<QPair<RVA, RVA>> merged;
+    for (const auto &part : mapped) {
+        if (!merged.isEmpty() && part.first <= merged.last().second) {
+            merged.last().second = qMax(merged.last().second, part.second);
+        } else {
+            merged.append(part);
+        }
+    }
+    if (merged.isEmpty()) {
+        merged.append({ range.from, range.to });
+    }
+
+    task = QSharedPointer<EntropyTask>(new EntropyTask(range.from, range.to, merged));
+    task->setSupersedeKey(this, QStringLiteral("entropyMap"));
+    connect(task.data(), &EntropyTask::entropyMapUpdated, this, [this, key](const EntropyMap &map) {
+        if (key != mapKey) {
+            // Superseded by a newer request
+            return;
+        }
+        this->map = map;
+        if (map.complete) {
+            cache.insert(key, new EntropyMap(map));
+        }
+        emit mapChanged();
+    });
+    Core()->getAsyncTaskManager()->start(task);
+}
@@ -0,0 +1,58 @@
+#ifndef ENTROPYMAPPROVIDER_H
+#define ENTROPYMAPPROVIDER_H
+
+#include "common/EntropyTask.h"
+
+#include <QObject>
+#include <QCache>
+
+/**
+ * @brief Shares one EntropyMap of the mapped address space between widgets
+ *
+ * The map is only computed once something requests it, in a background EntropyTask, and is
+ * cached per file (path, size, modification time and patches), so reopening the same file or
+ * refreshing does not recompute it.
+ */
+class EntropyMapProvider : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit EntropyMapProvider(QObject *parent = nullptr);
+    ~EntropyMapProvider() override;
+
+    /**
+     * @return the current, possibly partial or empty, map
+     */
+    const EntropyMap &getMap() const        { return map; }
+
+    /**
+     * @brief Start computing the map if it is not available or being computed already
+     */
+    void request();
+
+    /**
+     * @brief Identifies the contents of the opened file by path, size, modification time and patches
+     * Used as cache key for entropy, which would otherwise need the file hashed first.
+     */
+    static QString fileKey();
+
+signals:
+    void mapChanged();
+
+private:
+    EntropyMap map;
+    QString mapKey;
+    /**
+     * Only the last few files and patch states, every patch makes a new key
+     */
+    QCache<QString, EntropyMap> cache;
+    QSharedPointer<EntropyTask> task;
+
+    QString currentKey(RVA from, RVA to) const;
+
+private slots:
+    void invalidate();
+};
+
+#endif // ENTROPYMAPPROVIDER_H
@@ -0,0 +1,188 @@
+#include "common/EntropyTask.h"
+#include "common/CorePool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+static const int readChunkSize = 64 * 1024;
+
+EntropyBucket EntropyMap::average(RVA start, RVA end) const
+{
+    EntropyBucket ret;
+    if (isEmpty() || end <= from || start >= to) {
+        return ret;
+    }
+    start = qMax(start, from);
+    end = qMin(end, to);
+    double scale = static_cast<double>(buckets.size()) / static_cast<double>(to - from);
+    int first = static_cast<int>((start - from) * scale);
+    int last = qBound(first, static_cast<int>(std::ceil((end - from) * scale)), buckets.size());
+    first = qMin(first, buckets.size() - 1);
+    last = qMax(last, first + 1);
+    for (int i = first; i < last; i++) {
+        const EntropyBucket &b = buckets[i];
+        ret.entropy += b.entropy;
+        ret.zeros += b.zeros;
+        ret.printable += b.printable;
+        ret.high += b.high;
+    }
+    float n = last - first;
+    ret.entropy /= n;
+    ret.zeros /= n;
+    ret.printable /= n;
+    ret.high /= n;
+    return ret;
+}
+
+QColor EntropyMap::entropyColor(float entropy)
+{
+    float e = qBound(0.0f, entropy / 8.0f, 1.0f);
+    return QColor::fromHsvF((1.0f - e) * 2.0f / 3.0f, 0.9, 0.35 + 0.65 * e);
+}
+
+EntropyTask::EntropyTask(RVA from, RVA to, const QVector<QPair<RVA, RVA>> &mapped)
+    : from(from),
+      to(to),
+      mapped(mapped)
+{
+    setPriority(Priority::Background);
+}
+
+void EntropyTask::byteHistogram(const uchar *data, size_t size, quint32 *hist)
+{
+    // Counting into one table stalls on runs of the same byte, because every increment
+    // depends on the previous store. Interleaving four tables and loading 8 bytes at once
+    // keeps several independent increments in flight, which is what makes histograms fast.
+    quint32 h[4][256];
+    memset(h, 0, sizeof(h));
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        quint64 v;
+        memcpy(&v, data + i, sizeof(v));
+        h[0][v & 0xff]++;
+        h[1][(v >> 8) & 0xff]++;
+        h[2][(v >> 16) & 0xff]++;
+        h[3][(v >> 24) & 0xff]++;
+        h[0][(v >> 32) & 0xff]++;
+        h[1][(v >> 40) & 0xff]++;
+        h[2][(v >> 48) & 0xff]++;
+        h[3][v >> 56]++;
+    }
+    for (; i < size; i++) {
+        h[0][data[i]]++;
+    }
+    for (int b = 0; b < 256; b++) {
+        hist[b] += h[0][b] + h[1][b] + h[2][b] + h[3][b];
+    }
+}
+
+EntropyBucket EntropyTask::bucketFromHistogram(const quint32 *hist)
+{
+    EntropyBucket ret;
+    quint64 total = 0;
+    quint64 printable = 0;
+    quint64 high = 0;
+    for (int b = 0; b < 256; b++) {
+        total += hist[b];
+        if ((b >= 0x20 && b < 0x7f) || b == '\t' || b == '\n' || b == '\r') {
+            printable += hist[b];
+        } else if (b >= 0x80) {
+            high += hist[b];
+        }
+    }
+    if (!total) {
+        return ret;
+    }
+    double entropy = 0.0;
+    for (int b = 0; b < 256; b++) {
+        if (hist[b]) {
+            double p = static_cast<double>(hist[b]) / total;
+            entropy -= p * std::log2(p);
+        }
+    }
+    ret.entropy = static_cast<float>(entropy);
+    ret.zeros = static_cast<float>(hist[0]) / total;
+    ret.printable = static_cast<float>(printable) / total;
+    ret.high = static_cast<float>(high) / total;
+    return ret;
+}
+
+static int reverseBits(int v, int bits)
+{
+    int r = 0;
+    for (int i = 0; i < bits; i++) {
+        r = (r << 1) | (v & 1);
+        v >>= 1;
+    }
+    return r;
+}
+
+void EntropyTask::runTask()
+{
+    if (to <= from) {
+        return;
+    }
+
+    EntropyMap map;
+    map.from = from;
+    map.to = to;
+    map.buckets.resize(bucketCount);
+
+    RVA range = to - from;
+    RVA perBucket = range / bucketCount;
+    RVA remainder = range % bucketCount;
+    auto bucketStart = [&](int b) -> RVA {
+        return from + perBucket * b + remainder * b / bucketCount;
+    };
+
+    RVA mappedSize = 0;
+    for (const auto &part : mapped) {
+        mappedSize += part.second - part.first;
+    }
+    log(tr("Computing entropy of %1 bytes...").arg(mappedSize));
+    setProgress(0, bucketCount);
+
+    int nextEmit = 16;
+    quint32 hist[256];
+    for (int n = 0; n < bucketCount; n++) {
+        if (isInterrupted()) {
+            return;
+        }
+        int b = reverseBits(n, bucketCountLog2);
+        RVA start = bucketStart(b);
+        RVA end = bucketStart(b + 1);
+
+        memset(hist, 0, sizeof(hist));
+        // First mapped range ending after start
+        auto part = std::upper_bound(mapped.constBegin(), mapped.constEnd(), start,
+                                     [](RVA addr, const QPair<RVA, RVA> &r) {
+            return addr < r.second;
+        });
+        for (; part != mapped.constEnd() && part->first < end; ++part) {
+            RVA partEnd = qMin(end, part->second);
+            for (RVA addr = qMax(start, part->first); addr < partEnd; addr += readChunkSize) {
+                int len = static_cast<int>(qMin<RVA>(readChunkSize, partEnd - addr));
+                QByteArray data = Core()->getCorePool()->ioRead(addr, len);
+                byteHistogram(reinterpret_cast<const uchar *>(data.constData()),
+                              static_cast<size_t>(data.size()), hist);
+            }
+        }
+        map.buckets[b] = bucketFromHistogram(hist);
+
+        if (n + 1 == nextEmit) {
+            // The first n + 1 buckets in bit-reversed order are every step-th bucket
+            EntropyMap partial = map;
+            int step = bucketCount / (n + 1);
+            for (int i = 0; i < bucketCount; i++) {
+                if (i % step) {
+                    partial.buckets[i] = map.buckets[i - i % step];
+                }
+            }
+            partial.complete = n + 1 == bucketCount;
+            emit entropyMapUpdated(partial);
+            nextEmit *= 4;
+        }
+        setProgress(n + 1, bucketCount);
+    }
+}
@@ -0,0 +1,90 @@
+#ifndef ENTROPYTASK_H
+#define ENTROPYTASK_H
+
+#include "common/AsyncTask.h"
+#include "core/Cutter.h"
+
+#include <QPair>
+#include <QVector>
+#include <QColor>
+
+/**
+ * @brief Byte statistics of one bucket of an EntropyMap
+ * All values except entropy are ratios of the bucket size between 0 and 1.
+ */
+struct EntropyBucket {
+    float entropy = 0.0f; //!< Shannon entropy in bits per byte (0 to 8)
+    float zeros = 0.0f;
+    float printable = 0.0f;
+    float high = 0.0f; //!< bytes >= 0x80
+};
+
+/**
+ * @brief Entropy and byte classes of an address range split into equally sized buckets
+ */
+struct EntropyMap {
+    RVA from = 0;
+    RVA to = 0;
+    QVector<EntropyBucket> buckets;
+    bool complete = false;
+
+    bool isEmpty() const        { return buckets.isEmpty() || to <= from; }
+
+    /**
+     * @return the average over all buckets intersecting [start, end)
+     */
+    EntropyBucket average(RVA start, RVA end) const;
+
+    /**
+     * @brief Heatmap color for an entropy, from blue (low) to red (compressed or encrypted data)
+     */
+    static QColor entropyColor(float entropy);
+};
+
+Q_DECLARE_METATYPE(EntropyMap)
+
+/**
+ * @brief Computes an EntropyMap over a range of the mapped address space
+ *
+ * Only the mapped parts of the range are read, gaps between them count as empty, so sparse
+ * layouts do not read gigabytes of filler.
+ *
+ * Buckets are processed in bit-reversed order, so each time the number of computed buckets
+ * has quadrupled, they are evenly spread over the range. An intermediate map, where missing
+ * buckets are filled from their computed neighbour, is emitted at each of these steps,
+ * refining the result from coarse to fine.
+ */
+class EntropyTask : public AsyncTask
+{
+    Q_OBJECT
+
+public:
+    static const int bucketCountLog2 = 12;
+    static const int bucketCount = 1 << bucketCountLog2;
+
+    /**
+     * @param mapped sorted, disjoint [begin, end) ranges, the only ones read
+     */
+    EntropyTask(RVA from, RVA to, const QVector<QPair<RVA, RVA>> &mapped);
+
+    QString getTitle() override                     { return tr("Computing entropy"); }
+
+    /**
+     * @brief Count byte occurrences of data into hist (which is not cleared)
+     */
+    static void byteHistogram(const uchar *data, size_t size, quint32 *hist);
+    static EntropyBucket bucketFromHistogram(const quint32 *hist);
+
+signals:
+    void entropyMapUpdated(const EntropyMap &map);
+
+protected:
+    void runTask() override;
+
+private:
+    RVA from;
+    RVA to;
+    QVector<QPair<RVA, RVA>> mapped;
+};
+
+#endif // ENTROPYTASK_H
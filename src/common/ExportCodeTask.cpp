@@ -0,0 +1,270 @@
+#include "common/ExportCodeTask.h"
+#include "common/CorePool.h"
+
+#include <QtEndian>
+
+// Number of input bytes formatted on one output line
+static const int bytesPerRow = 16;
+
+ExportCodeTask::ExportCodeTask(const QString &fileName, Format format, RVA offset, RVA size,
+                               bool physical)
+    : fileName(fileName),
+      format(format),
+      offset(offset),
+      size(size),
+      physical(physical)
+{
+    setProgressUnit(tr("bytes"));
+}
+
+int ExportCodeTask::wordSize() const
+{
+    switch (format) {
+    case Format::CArray16:
+        return 2;
+    case Format::CArray32:
+        return 4;
+    case Format::CArray64:
+        return 8;
+    default:
+        return 1;
+    }
+}
+
+QByteArray ExportCodeTask::header() const
+{
+    RVA count = (size + wordSize() - 1) / wordSize();
+    switch (format) {
+    case Format::CArray8:
+    case Format::CArray16:
+    case Format::CArray32:
+    case Format::CArray64:
+        return QStringLiteral("#define _BUFFER_SIZE %1\nconst uint%2_t buffer[_BUFFER_SIZE] = {\n")
+               .arg(count).arg(wordSize() * 8).toLatin1();
+    case Format::CString:
+        return QStringLiteral("#define _BUFFER_SIZE %1\nconst char cstr[_BUFFER_SIZE + 1] = \"\"\n")
+               .arg(size).toLatin1();
+    case Format::Shell:
+        return QByteArrayLiteral("#!/bin/sh\nOUT=\"${1:-out.bin}\"\n: > \"$OUT\"\n");
+    case Format::Json:
+        return QByteArrayLiteral("[");
+    case Format::JavaScript:
+        return QByteArrayLiteral("var buffer = new Uint8Array([\n");
+    case Format::Python:
+        return QByteArrayLiteral("buf = b''\n");
+    default:
+        return QByteArray();
+    }
+}
+
+QByteArray ExportCodeTask::footer() const
+{
+    switch (format) {
+    case Format::CArray8:
+    case Format::CArray16:
+    case Format::CArray32:
+    case Format::CArray64:
+        return QByteArrayLiteral("};\n");
+    case Format::CString:
+        return QByteArrayLiteral(";\n");
+    case Format::Json:
+        return QByteArrayLiteral("]\n");
+    case Format::JavaScript:
+        return QByteArrayLiteral("]);\n");
+    default:
+        return QByteArray();
+    }
+}
+
+QByteArray ExportCodeTask::formatChunk(const QByteArray &data, RVA addr, bool first,
+                                       bool last) const
+{
+    if (format == Format::GasWithInstructions) {
+        // Disassembly can't be done without r2, let it format this chunk
+        QString cmd = QStringLiteral("pcA %1 @ %2").arg(data.size()).arg(addr);
+        if (physical) {
+            cmd += QStringLiteral(" @e:io.va=0");
+        }
+        return Core()->cmd(cmd).toUtf8();
+    }
+
+    QByteArray out;
+    out.reserve(data.size() * 6);
+
+    const auto *bytes = reinterpret_cast<const uchar *>(data.constData());
+    const int ws = wordSize();
+    for (int row = 0; row < data.size(); row += bytesPerRow) {
+        int rowEnd = qMin(row + bytesPerRow, data.size());
+        bool lastRow = last && rowEnd == data.size();
+        switch (format) {
+        case Format::CArray8:
+        case Format::CArray16:
+        case Format::CArray32:
+        case Format::CArray64:
+            out += "  ";
+            for (int i = row; i < rowEnd; i += ws) {
+                // Pad an incomplete trailing word with zeros
+                uchar word[8] = {};
+                memcpy(word, bytes + i, qMin(ws, data.size() - i));
+                quint64 v;
+                switch (ws) {
+                case 2:
+                    v = bigEndian ? qFromBigEndian<quint16>(word) : qFromLittleEndian<quint16>(word);
+                    break;
+                case 4:
+                    v = bigEndian ? qFromBigEndian<quint32>(word) : qFromLittleEndian<quint32>(word);
+                    break;
+                case 8:
+                    v = bigEndian ? qFromBigEndian<quint64>(word) : qFromLittleEndian<quint64>(word);
+                    break;
+                default:
+                    v = word[0];
+                    break;
+                }
+                out += "0x" + QByteArray::number(v, 16).rightJustified(ws * 2, '0');
+                if (i + ws < rowEnd) {
+                    out += ", ";
+                }
+            }
+            out += lastRow ? "\n" : ",\n";
+            break;
+        case Format::Json:
+        case Format::JavaScript:
+            if (format == Format::JavaScript) {
+                out += "  ";
+            } else if (!(first && row == 0)) {
+                // JSON is written on a single line, continue the previous row
+                out += ",";
+            }
+            for (int i = row; i < rowEnd; i++) {
+                out += QByteArray::number(bytes[i]);
+                if (i + 1 < rowEnd) {
+                    out += ",";
+                }
+            }
+            if (format == Format::JavaScript) {
+                out += lastRow ? "\n" : ",\n";
+            }
+            break;
+        case Format::CString:
+        case Format::Python:
+            out += format == Format::Python ? "buf += b'" : "  \"";
+            for (int i = row; i < rowEnd; i++) {
+                out += "\\x" + QByteArray::number(bytes[i], 16).rightJustified(2, '0');
+            }
+            out += format == Format::Python ? "'\n" : "\"\n";
+            break;
+        case Format::Shell:
+            // Octal escapes are the only ones POSIX printf guarantees
+            out += "printf '";
+            for (int i = row; i < rowEnd; i++) {
+                out += "\\" + QByteArray::number(bytes[i], 8).rightJustified(3, '0');
+            }
+            out += "' >> \"$OUT\"\n";
+            break;
+        case Format::R2Commands:
+            out += "wx " + data.mid(row, rowEnd - row).toHex()
+                   + " @ 0x" + QByteArray::number(addr + row, 16) + "\n";
+            break;
+        case Format::Gas:
+            out += ".byte ";
+            for (int i = row; i < rowEnd; i++) {
+                out += "0x" + QByteArray::number(bytes[i], 16).rightJustified(2, '0');
+                if (i + 1 < rowEnd) {
+                    out += ", ";
+                }
+            }
+            out += "\n";
+            break;
+        default:
+            break;
+        }
+    }
+    return out;
+}
+
+/**
+ * @brief Length of data up to the end of the last instruction that is not cut off by its end
+ *
+ * Only the tail of data is disassembled, so the core is not locked for the whole chunk.
+ * A linear sweep of variable length instructions falls into step with the one pcA does
+ * from the start of the chunk within a few instructions, long before the end of the tail.
+ */
+int ExportCodeTask::lastInstructionEnd(const QByteArray &data, RVA addr) const
+{
+    // Longer than any instruction, an instruction starting before it is complete
+    static const int maxInstructionSize = 32;
+    static const int tailSize = 4096;
+
+    const auto *bytes = reinterpret_cast<const ut8 *>(data.constData());
+    int pos = qMax(data.size() - tailSize, 0);
+    RCoreLocked core = Core()->core();
+    // The assembler is shared with everything else disassembling through the core
+    ut64 pc = core->assembler->pc;
+    while (pos < data.size() - maxInstructionSize) {
+        RAsmOp op;
+        r_asm_op_init(&op);
+        r_asm_set_pc(core->assembler, addr + pos);
+        r_asm_disassemble(core->assembler, &op, bytes + pos, data.size() - pos);
+        pos += qMax(op.size, 1);
+        r_asm_op_fini(&op);
+    }
+    r_asm_set_pc(core->assembler, pc);
+    return pos;
+}
+
+void ExportCodeTask::runTask()
+{
+    succeeded = false;
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        log(tr("Can't open file %1 for writing").arg(fileName));
+        emit exportFinished(false, fileName);
+        return;
+    }
+
+    bigEndian = Core()->getConfigb("cfg.bigendian");
+
+    log(tr("Exporting %1 bytes to %2...").arg(size).arg(fileName));
+    setProgress(0, static_cast<qint64>(size));
+
+    bool ok = file.write(header()) >= 0;
+    RVA done = 0;
+    while (ok && done < size) {
+        if (isInterrupted()) {
+            ok = false;
+            break;
+        }
+        int len = static_cast<int>(qMin<RVA>(chunkSize, size - done));
+        QByteArray data = Core()->getCorePool()->ioRead(offset + done, len, physical);
+        if (data.size() != len) {
+            log(tr("Failed to read %1 bytes at %2").arg(len).arg(RAddressString(offset + done)));
+            ok = false;
+            break;
+        }
+        if (format == Format::GasWithInstructions && done + len < size) {
+            // The cut off instruction starts the next chunk
+            len = lastInstructionEnd(data, offset + done);
+            data.truncate(len);
+        }
+        bool last = done + len >= size;
+        ok = file.write(formatChunk(data, offset + done, done == 0, last)) >= 0;
+        done += len;
+        setProgress(static_cast<qint64>(done), static_cast<qint64>(size));
+    }
+    ok = ok && file.write(footer()) >= 0;
+
+    file.close();
+    if (!ok) {
+        // remove() resets the error
+        QString error = file.errorString();
+        // Don't leave a truncated export behind
+        file.remove();
+        if (!isInterrupted()) {
+            log(tr("Export failed: %1").arg(error));
+        }
+    }
+    succeeded = ok;
+    emit exportFinished(ok, fileName);
+}
@@ -0,0 +1,58 @@
+
+#ifndef EXPORTCODETASK_H
+#define EXPORTCODETASK_H
+
+#include "common/AsyncTask.h"
+#include "core/Cutter.h"
+
+#include <QFile>
+
+/**
+ * @brief Writes a range of bytes to a file as source code (C array, Python, GAS, ...)
+ *
+ * The range is read and formatted in chunks of chunkSize bytes, so memory usage stays
+ * constant regardless of the size of the range and the export can be interrupted at
+ * any chunk boundary. An interrupted export removes the partially written file.
+ * With instructions, chunks end at an instruction boundary instead, so no instruction is cut.
+ */
+class ExportCodeTask : public AsyncTask
+{
+    Q_OBJECT
+
+public:
+    enum class Format {
+        CArray8, CArray16, CArray32, CArray64, CString,
+        Shell, Json, JavaScript, Python, R2Commands, Gas, GasWithInstructions
+    };
+
+    static const int chunkSize = 1024 * 1024;
+
+    ExportCodeTask(const QString &fileName, Format format, RVA offset, RVA size, bool physical);
+
+    QString getTitle() override                     { return tr("Exporting as code"); }
+
+    bool getSucceeded()                             { return succeeded; }
+
+signals:
+    void exportFinished(bool success, const QString &fileName);
+
+protected:
+    void runTask() override;
+
+private:
+    QString fileName;
+    Format format;
+    RVA offset;
+    RVA size;
+    bool physical;
+    bool bigEndian = false;
+    bool succeeded = false;
+
+    int wordSize() const;
+    QByteArray header() const;
+    QByteArray footer() const;
+    QByteArray formatChunk(const QByteArray &data, RVA addr, bool first, bool last) const;
+    int lastInstructionEnd(const QByteArray &data, RVA addr) const;
+};
+
+#endif // EXPORTCODETASK_H
@@ -0,0 +1,106 @@
+#include "common/NavbarRasterTask.h"
+
+#include <cstring>
+
+NavbarRasterTask::NavbarRasterTask(const BlockStatistics &stats, int width, int height,
+                                   const Colors &colors)
+    : stats(stats),
+      width(width),
+      height(height),
+      colors(colors)
+{
+}
+
+void NavbarRasterTask::setHeatmap(Mode mode, const EntropyMap &entropy)
+{
+    this->mode = mode;
+    this->entropy = entropy;
+}
+
+QRgb NavbarRasterTask::heatmapColor(RVA start, RVA end) const
+{
+    if (entropy.isEmpty() || end <= entropy.from || start >= entropy.to) {
+        return colors.empty.rgb();
+    }
+    EntropyBucket bucket = entropy.average(start, end);
+    if (mode == Mode::Entropy) {
+        return EntropyMap::entropyColor(bucket.entropy).rgb();
+    }
+    // Byte classes: red for high bytes, green for printable, blue for other control bytes,
+    // zeros stay dark
+    float other = qMax(0.0f, 1.0f - bucket.zeros - bucket.printable - bucket.high);
+    return QColor::fromRgbF(bucket.high, bucket.printable, other).rgb();
+}
+
+enum class DataType : int { Empty, Symbol, String, Code };
+
+static DataType blockDataType(const BlockDescription &block)
+{
+    if (block.functions > 0) {
+        return DataType::Code;
+    } else if (block.strings > 0) {
+        return DataType::String;
+    } else if (block.symbols > 0) {
+        return DataType::Symbol;
+    } else if (block.inFunctions > 0) {
+        return DataType::Code;
+    }
+    return DataType::Empty;
+}
+
+void NavbarRasterTask::runTask()
+{
+    if (width <= 0 || height <= 0 || stats.to <= stats.from) {
+        emit rasterFinished(QImage(), QVector<RVA>());
+        return;
+    }
+
+    // Start address of every column, computed without overflowing for 64 bit ranges
+    RVA range = stats.to - stats.from;
+    RVA perColumn = range / static_cast<RVA>(width);
+    RVA remainder = range % static_cast<RVA>(width);
+    QVector<RVA> columnAddresses(width + 1);
+    for (int x = 0; x <= width; x++) {
+        columnAddresses[x] = stats.from + perColumn * x + remainder * x / width;
+    }
+
+    QRgb typeColors[4];
+    typeColors[static_cast<int>(DataType::Empty)] = colors.empty.rgb();
+    typeColors[static_cast<int>(DataType::Symbol)] = colors.symbol.rgb();
+    typeColors[static_cast<int>(DataType::String)] = colors.string.rgb();
+    typeColors[static_cast<int>(DataType::Code)] = colors.code.rgb();
+
+    QImage image(width, height, QImage::Format_RGB32);
+    auto *row = reinterpret_cast<QRgb *>(image.scanLine(0));
+
+    // Blocks are sorted by address, so walk them along with the columns
+    const QList<BlockDescription> &blocks = stats.blocks;
+    int blockIndex = 0;
+    for (int x = 0; x < width; x++) {
+        if ((x & 0xff) == 0 && isInterrupted()) {
+            return;
+        }
+        RVA colStart = columnAddresses[x];
+        RVA colEnd = qMax(columnAddresses[x + 1], colStart + 1);
+        if (mode != Mode::DataTypes) {
+            row[x] = heatmapColor(colStart, colEnd);
+            continue;
+        }
+        while (blockIndex < blocks.size()
+                && blocks[blockIndex].addr + blocks[blockIndex].size <= colStart) {
+            blockIndex++;
+        }
+        // Several blocks may fall into one column, the most significant one wins
+        DataType type = DataType::Empty;
+        for (int i = blockIndex; i < blocks.size() && blocks[i].addr < colEnd; i++) {
+            type = qMax(type, blockDataType(blocks[i]));
+        }
+        row[x] = typeColors[static_cast<int>(type)];
+    }
+
+    for (int y = 1; y < height; y++) {
+        memcpy(image.scanLine(y), row, static_cast<size_t>(width) * sizeof(QRgb));
+    }
+
+    emit rasterFinished(image, columnAddresses);
+}
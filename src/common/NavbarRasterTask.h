@@ -0,0 +1,59 @@
+#ifndef NAVBARRASTERTASK_H
+#define NAVBARRASTERTASK_H
+
+#include "common/AsyncTask.h"
+#include "core/Cutter.h"
+#include "common/EntropyTask.h"
+
+#include <QImage>
+#include <QVector>
+#include <QColor>
+
+/**
+ * @brief Renders block statistics into an image with one column per pixel for VisualNavbar
+ *
+ * Besides the image, the result contains the start address of every column (plus the end
+ * address of the last one), which VisualNavbar uses to map between x and addresses by
+ * binary search.
+ */
+class NavbarRasterTask : public AsyncTask
+{
+    Q_OBJECT
+
+public:
+    enum class Mode { DataTypes, Entropy, ByteClasses };
+
+    struct Colors {
+        QColor empty;
+        QColor code;
+        QColor string;
+        QColor symbol;
+    };
+
+    NavbarRasterTask(const BlockStatistics &stats, int width, int height, const Colors &colors);
+
+    /**
+     * @brief Draw a heatmap of entropy instead of the data types from the statistics
+     */
+    void setHeatmap(Mode mode, const EntropyMap &entropy);
+
+    QString getTitle() override                     { return tr("Drawing navigation bar"); }
+
+signals:
+    void rasterFinished(const QImage &image, const QVector<RVA> &columnAddresses);
+
+protected:
+    void runTask() override;
+
+private:
+    BlockStatistics stats;
+    int width;
+    int height;
+    Colors colors;
+    Mode mode = Mode::DataTypes;
+    EntropyMap entropy;
+
+    QRgb heatmapColor(RVA start, RVA end) const;
+};
+
+#endif // NAVBARRASTERTASK_H
@@ -0,0 +1,146 @@
+#include "common/Parallel.h"
+
+#include <QAtomicInt>
+#include <QSemaphore>
+
+Q_GLOBAL_STATIC(QThreadPool, cpuPool)
+
+namespace {
+
+class Helper : public QRunnable
+{
+public:
+    Helper(const std::function<void()> &work, QSemaphore *finished)
+        : work(work), finished(finished)
+    {
+        setAutoDelete(false);
+    }
+
+    void run() override
+    {
+        work();
+        finished->release();
+    }
+
+private:
+    const std::function<void()> &work;
+    QSemaphore *finished;
+};
+
+}
+
+class Parallel::Pipeline::Job : public QRunnable
+{
+public:
+    Job(const std::function<void()> &work, const std::function<void()> &collect)
+        : work(work), collect(collect)
+    {
+        setAutoDelete(false);
+    }
+
+    void run() override
+    {
+        work();
+        // Whatever the work captured, like its input, is not needed anymore
+        work = nullptr;
+        done.release();
+    }
+
+    std::function<void()> work;
+    std::function<void()> collect;
+    QSemaphore done;
+};
+
+QThreadPool *Parallel::pool()
+{
+    return cpuPool();
+}
+
+void Parallel::forChunks(int count, int grain, const std::function<void(int, int)> &func)
+{
+    if (count <= 0) {
+        return;
+    }
+    grain = qMax(grain, 1);
+    const int chunks = static_cast<int>((static_cast<qint64>(count) + grain - 1) / grain);
+    // The calling thread is one of the workers
+    const int helperCount = qMin(chunks, pool()->maxThreadCount()) - 1;
+    if (helperCount <= 0) {
+        func(0, count);
+        return;
+    }
+
+    QAtomicInt nextChunk;
+    std::function<void()> work = [&]() {
+        int chunk;
+        while ((chunk = nextChunk.fetchAndAddRelaxed(1)) < chunks) {
+            int begin = chunk * grain;
+            func(begin, qMin(begin + grain, count));
+        }
+    };
+
+    QSemaphore finished;
+    QVector<Helper *> helpers;
+    for (int i = 0; i < helperCount; i++) {
+        helpers.append(new Helper(work, &finished));
+        pool()->start(helpers.last());
+    }
+    work();
+
+    // Helpers which did not start yet have nothing left to do, only wait for the others
+    int started = 0;
+    for (Helper *helper : helpers) {
+        if (!pool()->tryTake(helper)) {
+            started++;
+        }
+    }
+    finished.acquire(started);
+    qDeleteAll(helpers);
+}
+
+Parallel::Pipeline::~Pipeline()
+{
+    cancel();
+}
+
+void Parallel::Pipeline::add(const std::function<void()> &work,
+                             const std::function<void()> &collect)
+{
+    auto job = new Job(work, collect);
+    jobs.enqueue(job);
+    pool()->start(job);
+
+    // Keep the order of the results and a bounded amount of data in flight
+    while (jobs.size() > 2 * pool()->maxThreadCount()) {
+        collectNext();
+    }
+    while (!jobs.isEmpty() && jobs.head()->done.available()) {
+        collectNext();
+    }
+}
+
+void Parallel::Pipeline::finish()
+{
+    while (!jobs.isEmpty()) {
+        collectNext();
+    }
+}
+
+void Parallel::Pipeline::cancel()
+{
+    for (Job *job : jobs) {
+        if (!pool()->tryTake(job)) {
+            job->done.acquire();
+        }
+        delete job;
+    }
+    jobs.clear();
+}
+
+void Parallel::Pipeline::collectNext()
+{
+    Job *job = jobs.dequeue();
+    job->done.acquire();
+    job->collect();
+    delete job;
+}
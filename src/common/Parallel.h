@@ -0,0 +1,136 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <QList>
+#include <QQueue>
+#include <QThreadPool>
+#include <QVector>
+
+#include <algorithm>
+#include <functional>
+
+/**
+ * @brief Spreading CPU-only work like converting JSON, sorting or building indices over all cores
+ *
+ * The work runs in a thread pool of its own, separate from the AsyncTaskManager pools whose
+ * threads mostly wait for the core lock, so it must not use r2. The calling thread takes part
+ * in the work and idle threads take the next chunk as soon as they are done, so uneven chunks
+ * balance out and calls can be nested without blocking each other.
+ */
+namespace Parallel {
+
+/**
+ * @brief The pool for CPU-only work, with one thread per core
+ */
+QThreadPool *pool();
+
+/**
+ * @brief Call func for consecutive ranges [begin, end) covering [0, count) in parallel
+ * @param grain size of the ranges, small counts run in the calling thread only
+ */
+void forChunks(int count, int grain, const std::function<void(int begin, int end)> &func);
+
+/**
+ * @brief The results of func(i) for every i in [0, count), computed in parallel
+ */
+template<class T, class Func>
+QList<T> map(int count, Func func, int grain = 256)
+{
+    QVector<T> results(count);
+    T *out = results.data();
+    forChunks(count, grain, [out, &func](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            out[i] = func(i);
+        }
+    });
+    QList<T> ret;
+    ret.reserve(count);
+    for (const T &result : results) {
+        ret.append(result);
+    }
+    return ret;
+}
+
+/**
+ * @brief Runs jobs in pool() while the calling thread prepares the next ones, like reading the
+ * data for them, and collects their results in the calling thread in the order they were added
+ *
+ * At most a few jobs per thread are in flight, add() collects finished ones before it returns.
+ */
+class Pipeline
+{
+public:
+    Pipeline() = default;
+    ~Pipeline();
+
+    /**
+     * @param work runs in the pool, it must not use r2
+     * @param collect runs in the calling thread once work is done
+     */
+    void add(const std::function<void()> &work, const std::function<void()> &collect);
+
+    /**
+     * @brief Collect all jobs added so far
+     */
+    void finish();
+
+    /**
+     * @brief Drop all jobs added so far without collecting them
+     * Only those already running are waited for.
+     */
+    void cancel();
+
+private:
+    Q_DISABLE_COPY(Pipeline)
+
+    class Job;
+
+    QQueue<Job *> jobs;
+
+    void collectNext();
+};
+
+/**
+ * @brief std::sort() of parts in parallel, followed by merging them pairwise
+ * Not stable. Iterators have to be random access, like those of QList and QVector.
+ */
+template<class Iterator, class LessThan>
+void sort(Iterator begin, Iterator end, LessThan lessThan)
+{
+    // Sorting fewer elements in parallel costs more than it saves
+    static const int minPartSize = 4096;
+    const int count = static_cast<int>(end - begin);
+    const int parts = qMin(pool()->maxThreadCount(), count / minPartSize);
+    if (parts < 2) {
+        std::sort(begin, end, lessThan);
+        return;
+    }
+
+    QVector<int> bounds(parts + 1);
+    for (int i = 0; i <= parts; i++) {
+        bounds[i] = static_cast<int>(static_cast<qint64>(count) * i / parts);
+    }
+    forChunks(parts, 1, [&](int first, int last) {
+        for (int part = first; part < last; part++) {
+            std::sort(begin + bounds[part], begin + bounds[part + 1], lessThan);
+        }
+    });
+    for (int width = 1; width < parts; width *= 2) {
+        int pairs = (parts + 2 * width - 1) / (2 * width);
+        forChunks(pairs, 1, [&](int first, int last) {
+            for (int pair = first; pair < last; pair++) {
+                int left = pair * 2 * width;
+                int middle = qMin(left + width, parts);
+                int right = qMin(left + 2 * width, parts);
+                if (middle < right) {
+                    std::inplace_merge(begin + bounds[left], begin + bounds[middle],
+                                       begin + bounds[right], lessThan);
+                }
+            }
+        });
+    }
+}
+
+}
+
+#endif // PARALLEL_H
@@ -0,0 +1,232 @@
+#include "common/PatternMatcher.h"
+
+#include <QCoreApplication>
+#include <QQueue>
+
+// Longer anchors hardly find fewer candidates but make the automaton larger
+static const int maxAnchorLength = 8;
+
+static int hexValue(QChar c)
+{
+    if (c >= '0' && c <= '9') {
+        return c.unicode() - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c.unicode() - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c.unicode() - 'A' + 10;
+    }
+    return -1;
+}
+
+bool PatternMatcher::parsePattern(const QString &text, Pattern *pattern, QString *error)
+{
+    auto fail = [error](const QString &message) {
+        if (error) {
+            *error = message;
+        }
+        return false;
+    };
+
+    QString digits = text;
+    digits.remove(QRegExp("\\s"));
+    if (digits.startsWith("0x", Qt::CaseInsensitive)) {
+        digits.remove(0, 2);
+    }
+    if (digits.isEmpty()) {
+        return fail(QCoreApplication::translate("PatternMatcher", "Empty pattern"));
+    }
+    if (digits.size() % 2) {
+        return fail(QCoreApplication::translate("PatternMatcher",
+                                                "Pattern %1 has an odd number of digits").arg(text));
+    }
+
+    QByteArray bytes(digits.size() / 2, 0);
+    QByteArray mask(digits.size() / 2, 0);
+    for (int i = 0; i < digits.size(); i++) {
+        int shift = i % 2 ? 0 : 4;
+        if (digits[i] == '?') {
+            continue;
+        }
+        int value = hexValue(digits[i]);
+        if (value < 0) {
+            return fail(QCoreApplication::translate("PatternMatcher",
+                                                    "Invalid character %1 in pattern %2")
+                        .arg(digits[i]).arg(text));
+        }
+        bytes[i / 2] = static_cast<char>(bytes[i / 2] | (value << shift));
+        mask[i / 2] = static_cast<char>(mask[i / 2] | (0xf << shift));
+    }
+    pattern->bytes = bytes;
+    pattern->mask = mask;
+    return true;
+}
+
+bool PatternMatcher::parsePatternList(const QString &text, QList<Pattern> *patterns,
+                                      QString *error)
+{
+    const QStringList lines = text.split('\n');
+    for (int i = 0; i < lines.size(); i++) {
+        QString line = lines[i].section('#', 0, 0).trimmed();
+        if (line.isEmpty()) {
+            continue;
+        }
+        Pattern pattern;
+        int colon = line.lastIndexOf(':');
+        QString hex = line.mid(colon + 1);
+        QString lineError;
+        if (!parsePattern(hex, &pattern, &lineError)) {
+            if (error) {
+                *error = QCoreApplication::translate("PatternMatcher", "Line %1: %2")
+                         .arg(i + 1).arg(lineError);
+            }
+            return false;
+        }
+        pattern.name = colon < 0 ? hex.simplified() : line.left(colon).trimmed();
+        patterns->append(pattern);
+    }
+    return true;
+}
+
+PatternMatcher::PatternMatcher(const QList<Pattern> &patterns)
+    : patterns(patterns)
+{
+    build();
+}
+
+void PatternMatcher::build()
+{
+    // The trie of all anchors, -1 where it has no transition
+    transitions.fill(-1, 256);
+    QVector<QVector<Anchor>> stateAnchors(1);
+
+    for (int p = 0; p < patterns.size(); p++) {
+        const Pattern &pattern = patterns[p];
+        maxLength = qMax(maxLength, pattern.bytes.size());
+
+        int bestStart = 0;
+        int bestLength = 0;
+        int runStart = 0;
+        for (int i = 0; i <= pattern.mask.size(); i++) {
+            if (i < pattern.mask.size() && static_cast<uchar>(pattern.mask[i]) == 0xff) {
+                continue;
+            }
+            if (i - runStart > bestLength) {
+                bestStart = runStart;
+                bestLength = i - runStart;
+            }
+            runStart = i + 1;
+        }
+        if (!bestLength) {
+            unanchored.append(p);
+            continue;
+        }
+        bestLength = qMin(bestLength, maxAnchorLength);
+
+        int state = 0;
+        for (int i = bestStart; i < bestStart + bestLength; i++) {
+            int index = state * 256 + static_cast<uchar>(pattern.bytes[i]);
+            if (transitions[index] < 0) {
+                transitions[index] = stateAnchors.size();
+                stateAnchors.append(QVector<Anchor>());
+                transitions.insert(transitions.end(), 256, -1);
+            }
+            state = transitions[index];
+        }
+        stateAnchors[state].append(Anchor { p, bestStart + bestLength });
+    }
+
+    // Breadth first, so the longest proper suffix of each state is complete before the state
+    QVector<int> suffix(stateAnchors.size(), 0);
+    QQueue<int> queue;
+    for (int c = 0; c < 256; c++) {
+        int &next = transitions[c];
+        if (next < 0) {
+            next = 0;
+        } else {
+            queue.enqueue(next);
+        }
+    }
+    while (!queue.isEmpty()) {
+        int state = queue.dequeue();
+        stateAnchors[state] += stateAnchors[suffix[state]];
+        for (int c = 0; c < 256; c++) {
+            int fallback = transitions[suffix[state] * 256 + c];
+            int &next = transitions[state * 256 + c];
+            if (next < 0) {
+                next = fallback;
+            } else {
+                suffix[next] = fallback;
+                queue.enqueue(next);
+            }
+        }
+    }
+
+    anchorStart.reserve(stateAnchors.size() + 1);
+    for (const QVector<Anchor> &found : stateAnchors) {
+        anchorStart.append(anchors.size());
+        anchors += found;
+    }
+    anchorStart.append(anchors.size());
+}
+
+bool PatternMatcher::matches(const Pattern &pattern, const uchar *data) const
+{
+    const auto bytes = reinterpret_cast<const uchar *>(pattern.bytes.constData());
+    const auto mask = reinterpret_cast<const uchar *>(pattern.mask.constData());
+    for (int i = 0; i < pattern.bytes.size(); i++) {
+        if ((data[i] & mask[i]) != bytes[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void PatternMatcher::report(int pattern, const uchar *data, RVA vaddr,
+                            QList<SearchDescription> *out) const
+{
+    const Pattern &p = patterns[pattern];
+    QByteArray bytes(reinterpret_cast<const char *>(data), p.bytes.size());
+    SearchDescription hit;
+    hit.offset = vaddr;
+    hit.size = p.bytes.size();
+    hit.data = QString("%1: %2").arg(p.name, QString::fromLatin1(bytes.toHex()));
+    out->append(hit);
+}
+
+void PatternMatcher::scan(const uchar *data, int size, int ownedSize, RVA vaddr,
+                          QList<SearchDescription> *out) const
+{
+    if (patterns.isEmpty()) {
+        return;
+    }
+    // Anchors ending after this can only belong to matches starting beyond ownedSize
+    const int end = static_cast<int>(qMin<qint64>(size, static_cast<qint64>(ownedSize) + maxLength - 1));
+    const qint32 *table = transitions.constData();
+    int state = 0;
+    for (int i = 0; i < end; i++) {
+        state = table[state * 256 + data[i]];
+        for (int a = anchorStart[state]; a < anchorStart[state + 1]; a++) {
+            const Anchor &anchor = anchors[a];
+            int start = i + 1 - anchor.end;
+            const Pattern &pattern = patterns[anchor.pattern];
+            if (start < 0 || start >= ownedSize || start + pattern.bytes.size() > size) {
+                continue;
+            }
+            if (matches(pattern, data + start)) {
+                report(anchor.pattern, data + start, vaddr + static_cast<RVA>(start), out);
+            }
+        }
+    }
+
+    for (int p : unanchored) {
+        const Pattern &pattern = patterns[p];
+        int last = qMin(ownedSize, size - pattern.bytes.size() + 1);
+        for (int start = 0; start < last; start++) {
+            if (matches(pattern, data + start)) {
+                report(p, data + start, vaddr + static_cast<RVA>(start), out);
+            }
+        }
+    }
+}
@@ -0,0 +1,79 @@
+#ifndef PATTERNMATCHER_H
+#define PATTERNMATCHER_H
+
+#include "core/CutterDescriptions.h"
+
+#include <QByteArray>
+#include <QList>
+#include <QVector>
+
+/**
+ * @brief Finds many byte patterns with wildcards in one pass over a buffer
+ *
+ * Every pattern has a mask, so single nibbles or whole bytes can be left open. The longest
+ * run of fixed bytes of each pattern is compiled into one Aho-Corasick automaton, which finds
+ * all candidate positions at the cost of one table lookup per byte, and only those are
+ * compared with the full pattern. Patterns without a fixed byte are compared everywhere.
+ * A matcher is not modified by scanning, so one instance can scan several buffers in parallel.
+ */
+class PatternMatcher
+{
+public:
+    struct Pattern {
+        QString name;
+        QByteArray bytes;
+        QByteArray mask; //!< Bits set in the mask have to match bytes
+    };
+
+    /**
+     * @brief Parse hex like "4d 5a ?? ?? 50 4?", where ? leaves a nibble open
+     * @return false and an error message if text is no valid pattern
+     */
+    static bool parsePattern(const QString &text, Pattern *pattern, QString *error = nullptr);
+
+    /**
+     * @brief Parse one pattern per line, optionally named as in "name: 4d 5a"
+     * Empty lines and everything after a # are ignored.
+     */
+    static bool parsePatternList(const QString &text, QList<Pattern> *patterns,
+                                 QString *error = nullptr);
+
+    explicit PatternMatcher(const QList<Pattern> &patterns);
+
+    bool isEmpty() const                    { return patterns.isEmpty(); }
+    int getMaxLength() const                { return maxLength; }
+
+    /**
+     * @brief Append all matches starting in the first ownedSize bytes of data to out
+     * Matches have to lie completely inside data, so consecutive buffers have to overlap by
+     * getMaxLength() - 1 bytes for no match to be lost at their border.
+     * @param vaddr address of the first byte of data
+     */
+    void scan(const uchar *data, int size, int ownedSize, RVA vaddr,
+              QList<SearchDescription> *out) const;
+
+private:
+    struct Anchor {
+        int pattern;
+        int end; //!< Offset in the pattern after the last byte of the anchor
+    };
+
+    QList<Pattern> patterns;
+    int maxLength = 0;
+
+    /**
+     * Transitions of the automaton, 256 per state with state 0 the root.
+     * The anchors found when entering a state, including those of its suffixes, are
+     * anchors[anchorStart[state]] up to anchors[anchorStart[state + 1]].
+     */
+    QVector<qint32> transitions;
+    QVector<int> anchorStart;
+    QVector<Anchor> anchors;
+    QVector<int> unanchored;
+
+    void build();
+    bool matches(const Pattern &pattern, const uchar *data) const;
+    void report(int pattern, const uchar *data, RVA vaddr, QList<SearchDescription> *out) const;
+};
+
+#endif // PATTERNMATCHER_H
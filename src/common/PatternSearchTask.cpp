@@ -0,0 +1,65 @@
+#include "common/PatternSearchTask.h"
+#include "common/CorePool.h"
+#include "common/Parallel.h"
+
+#include <QSharedPointer>
+
+static const RVA readChunkSize = 4 * 1024 * 1024;
+
+PatternSearchTask::PatternSearchTask(const QList<PatternMatcher::Pattern> &patterns,
+                                     const QList<Range> &ranges, int maxHits)
+    : SearchTask(QString(), QString(), ranges, maxHits),
+      matcher(patterns),
+      patternCount(patterns.size())
+{
+}
+
+QString PatternSearchTask::getTitle()
+{
+    return tr("Searching for %n byte pattern(s)", nullptr, patternCount);
+}
+
+void PatternSearchTask::runTask()
+{
+    // Consecutive chunks overlap so a match starting at the end of one is still complete
+    const RVA overlap = static_cast<RVA>(qMax(matcher.getMaxLength() - 1, 0));
+
+    qint64 total = totalSize();
+    qint64 done = 0;
+    setProgress(0, total);
+    if (matcher.isEmpty()) {
+        return;
+    }
+
+    // Reads go through the CorePool without the core lock, so this thread reads the next chunks
+    // while the shared CPU pool scans the previous ones
+    Parallel::Pipeline pipeline;
+    bool stopped = false;
+
+    for (const Range &range : ranges) {
+        for (RVA from = range.first; from < range.second; from += readChunkSize) {
+            if (stopped || isInterrupted()) {
+                pipeline.cancel();
+                return;
+            }
+            RVA end = qMin(range.second, from + readChunkSize);
+            RVA to = qMin(range.second, end + overlap);
+            QByteArray data = Core()->getCorePool()->ioRead(from, static_cast<int>(to - from));
+            if (!data.isEmpty()) {
+                QSharedPointer<QList<SearchDescription>> hits(new QList<SearchDescription>);
+                int ownedSize = static_cast<int>(end - from);
+                pipeline.add([this, data, from, ownedSize, hits]() {
+                    matcher.scan(reinterpret_cast<const uchar *>(data.constData()), data.size(),
+                                 qMin(ownedSize, data.size()), from, hits.data());
+                }, [this, &stopped, from, end, hits]() {
+                    if (!stopped) {
+                        stopped = !reportHits(*hits, from, end);
+                    }
+                });
+            }
+            done += static_cast<qint64>(end - from);
+            setProgress(done, total);
+        }
+    }
+    pipeline.finish();
+}
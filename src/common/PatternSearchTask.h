@@ -0,0 +1,32 @@
+#ifndef PATTERNSEARCHTASK_H
+#define PATTERNSEARCHTASK_H
+
+#include "common/PatternMatcher.h"
+#include "common/SearchTask.h"
+
+/**
+ * @brief Searches the ranges for any number of byte patterns at once with a PatternMatcher
+ *
+ * The bytes are read through the CorePool in chunks and scanned in the shared CPU pool while
+ * the next chunks are read. Hits are delivered like those of a SearchTask, in address order
+ * per range.
+ */
+class PatternSearchTask : public SearchTask
+{
+    Q_OBJECT
+
+public:
+    PatternSearchTask(const QList<PatternMatcher::Pattern> &patterns, const QList<Range> &ranges,
+                      int maxHits);
+
+    QString getTitle() override;
+
+protected:
+    void runTask() override;
+
+private:
+    PatternMatcher matcher;
+    int patternCount;
+};
+
+#endif // PATTERNSEARCHTASK_H
@@ -0,0 +1,90 @@
+#include "common/R2Process.h"
+
+#include <QStandardPaths>
+
+// Milliseconds between two checks for an interruption while waiting for output
+static const int pollInterval = 100;
+
+R2Process::R2Process()
+{
+    // Nobody reads it, so it must not fill up the pipe and block the child
+    process.setStandardErrorFile(QProcess::nullDevice());
+}
+
+R2Process::~R2Process()
+{
+    kill();
+}
+
+bool R2Process::start(const QStringList &args)
+{
+    // Prefer the radare2 shipped with Cutter over the one in PATH
+    QString program = QStandardPaths::findExecutable("radare2",
+                                                     { QCoreApplication::applicationDirPath() });
+    if (program.isEmpty()) {
+        program = QStandardPaths::findExecutable("radare2");
+    }
+    if (program.isEmpty()) {
+        error = tr("radare2 was not found");
+        return false;
+    }
+
+    // -0 terminates every output with a null byte, starting with the one of loading the file
+    process.start(program, QStringList { "-q0" } + args);
+    if (!process.waitForStarted()) {
+        error = process.errorString();
+        return false;
+    }
+    pendingCount = 1;
+    return true;
+}
+
+void R2Process::send(const QString &command)
+{
+    QByteArray line = command.toUtf8();
+    line.replace('\n', ';');
+    line.append('\n');
+    process.write(line);
+    pendingCount++;
+}
+
+bool R2Process::receive(QByteArray *output, const std::function<bool()> &interrupted)
+{
+    int end;
+    while (true) {
+        buffer += process.readAllStandardOutput();
+        end = buffer.indexOf('\0');
+        if (end >= 0) {
+            break;
+        }
+        if (process.state() == QProcess::NotRunning) {
+            if (error.isEmpty()) {
+                error = process.exitStatus() == QProcess::CrashExit
+                        ? tr("radare2 crashed")
+                        : tr("radare2 exited with code %1").arg(process.exitCode());
+            }
+            return false;
+        }
+        if (interrupted && interrupted()) {
+            error = tr("Interrupted");
+            kill();
+            return false;
+        }
+        process.waitForReadyRead(pollInterval);
+    }
+
+    if (output) {
+        *output = buffer.left(end);
+    }
+    buffer.remove(0, end + 1);
+    pendingCount--;
+    return true;
+}
+
+void R2Process::kill()
+{
+    if (process.state() != QProcess::NotRunning) {
+        process.kill();
+        process.waitForFinished();
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef R2PROCESS_H
+#define R2PROCESS_H
+
+#include <QCoreApplication>
+#include <QProcess>
+
+#include <functional>
+
+/**
+ * @brief radare2 running in a child process, talked to through its stdin and stdout like r2pipe
+ *
+ * Commands are pipelined: send() writes them right away and their outputs are received in the
+ * same order, so the child does not wait for the next command in between. A crash of the child
+ * only fails the commands still pending.
+ *
+ * Receiving blocks and does not need an event loop, so it is meant for the thread of a task,
+ * which also has to be the one that created it.
+ */
+class R2Process
+{
+    Q_DECLARE_TR_FUNCTIONS(R2Process)
+
+public:
+    R2Process();
+    ~R2Process();
+
+    /**
+     * @brief Start radare2 with args, the file to open being the last one
+     * The output of loading the file is the first one to receive.
+     */
+    bool start(const QStringList &args);
+
+    void send(const QString &command);
+
+    /**
+     * @brief Wait for the output of the oldest command not received yet
+     * @param output may be null to skip it
+     * @param interrupted checked regularly while waiting, the child is killed once it returns true
+     * @return false if the child is gone, see errorString()
+     */
+    bool receive(QByteArray *output, const std::function<bool()> &interrupted);
+
+    /**
+     * @brief Number of sent commands whose output was not received yet
+     */
+    int pending() const                 { return pendingCount; }
+
+    QString errorString() const         { return error; }
+
+private:
+    QProcess process;
+    QByteArray buffer;
+    int pendingCount = 0;
+    QString error;
+
+    void kill();
+};
+
+#endif // R2PROCESS_H
@@ -24,6 +24,7 @@ void R2Task::taskFinishedCallback(void *user, char *)
 
 void R2Task::taskFinished()
 {
+    finishedSemaphore.release();
     emit finished();
 }
 
@@ -37,9 +38,15 @@ void R2Task::breakTask()
     r_core_task_break(Core()->core(), task->id);
 }
 
-void R2Task::joinTask()
+bool R2Task::joinTask(int timeout)
 {
+    bool inTime = timeout < 0 || finishedSemaphore.tryAcquire(1, timeout);
+    if (!inTime) {
+        // The command ends at the next point it checks for a break
+        breakTask();
+    }
     r_core_task_join(Core()->core(), nullptr, task->id);
+    return inTime;
 }
 
 QString R2Task::getResult()
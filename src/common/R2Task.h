@@ -4,12 +4,15 @@
 
 #include "core/Cutter.h"
 
+#include <QSemaphore>
+
 class R2Task: public QObject
 {
     Q_OBJECT
 
 private:
     RCoreTask *task;
+    QSemaphore finishedSemaphore;
 
     static void taskFinishedCallback(void *user, char *);
     void taskFinished();
@@ -20,7 +23,12 @@ public:
 
     void startTask();
     void breakTask();
-    void joinTask();
+    /**
+     * @brief Wait for the task to finish
+     * @param timeout milliseconds after which the task is broken, -1 to wait until it is done
+     * @return false if it had to be broken
+     */
+    bool joinTask(int timeout = -1);
 
     QString getResult();
     const char *getResultRaw();
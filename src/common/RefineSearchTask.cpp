@@ -0,0 +1,58 @@
+#include "common/RefineSearchTask.h"
+#include "common/CorePool.h"
+
+#include <algorithm>
+
+// Progress is updated and interruption checked after this many hits
+static const int hitsPerStep = 256;
+
+RefineSearchTask::RefineSearchTask(const QList<SearchDescription> &hits,
+                                   const QList<PatternMatcher::Pattern> &patterns, int maxHits)
+    : SearchTask(QString(), QString(), QList<Range>(), maxHits),
+      hits(hits),
+      matcher(patterns)
+{
+    setProgressUnit(tr("hits"));
+    std::sort(this->hits.begin(), this->hits.end(), [](const SearchDescription &a,
+                                                       const SearchDescription &b) {
+        return a.offset < b.offset;
+    });
+}
+
+QString RefineSearchTask::getTitle()
+{
+    return tr("Refining %n search hit(s)", nullptr, hits.size());
+}
+
+void RefineSearchTask::runTask()
+{
+    const int length = matcher.getMaxLength();
+    setProgress(0, hits.size());
+    if (matcher.isEmpty()) {
+        return;
+    }
+
+    for (int i = 0; i < hits.size(); i += hitsPerStep) {
+        if (isInterrupted()) {
+            return;
+        }
+        int last = qMin(i + hitsPerStep, hits.size());
+        QList<SearchDescription> found;
+        for (int j = i; j < last; j++) {
+            const SearchDescription &hit = hits[j];
+            QByteArray data = Core()->getCorePool()->ioRead(hit.offset, length);
+            QList<SearchDescription> matches;
+            matcher.scan(reinterpret_cast<const uchar *>(data.constData()), data.size(), 1,
+                         hit.offset, &matches);
+            for (SearchDescription &match : matches) {
+                // What was found there originally is still the most useful description
+                match.code = hit.code;
+                found << match;
+            }
+        }
+        if (!reportHits(found, 0, RVA_MAX)) {
+            return;
+        }
+        setProgress(last, hits.size());
+    }
+}
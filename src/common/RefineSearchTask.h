@@ -0,0 +1,32 @@
+#ifndef REFINESEARCHTASK_H
+#define REFINESEARCHTASK_H
+
+#include "common/PatternMatcher.h"
+#include "common/SearchTask.h"
+
+/**
+ * @brief Narrows down the hits of a previous search to those where patterns match now
+ *
+ * Only the bytes at the previous hits are read, so each refinement takes time proportional
+ * to the number of hits instead of the size of the binary, like the next scan of a memory
+ * scanner. Hits are delivered like those of a SearchTask.
+ */
+class RefineSearchTask : public SearchTask
+{
+    Q_OBJECT
+
+public:
+    RefineSearchTask(const QList<SearchDescription> &hits,
+                     const QList<PatternMatcher::Pattern> &patterns, int maxHits);
+
+    QString getTitle() override;
+
+protected:
+    void runTask() override;
+
+private:
+    QList<SearchDescription> hits;
+    PatternMatcher matcher;
+};
+
+#endif // REFINESEARCHTASK_H
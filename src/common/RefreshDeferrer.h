@@ -2,6 +2,8 @@
 #ifndef REFRESHDEFERRER_H
 #define REFRESHDEFERRER_H
 
+#include "common/RefreshRanges.h"
+
 #include <QObject>
 
 class CutterDockWidget;
@@ -95,6 +97,69 @@ protected:
     }
 };
 
+/**
+ * @brief Accumulator taking params of type T instead of void pointers
+ * @tparam T The type of the params, passed to RefreshDeferrer::attemptRefreshWith()
+ * @tparam Result The type of the accumulated result passed to RefreshDeferrer::refreshNow()
+ *
+ * Subclasses only see references, the params are deleted by this class. Null params are ignored.
+ */
+template<class T, class Result = T>
+class TypedRefreshDeferrerAccumulator: public RefreshDeferrerAccumulator
+{
+protected:
+    virtual void accumulateTyped(const T &params) =0;
+    virtual const Result &typedResult() =0;
+
+private:
+    void accumulate(RefreshDeferrerParams params) final
+    {
+        auto typed = static_cast<T *>(params);
+        if (typed) {
+            accumulateTyped(*typed);
+        }
+        delete typed;
+    }
+
+    void ignoreParams(RefreshDeferrerParams params) final
+    {
+        delete static_cast<T *>(params);
+    }
+
+    RefreshDeferrerParamsResult result() final
+    {
+        return const_cast<Result *>(&typedResult());
+    }
+};
+
+/**
+ * @brief Accumulator uniting the RefreshRanges of all deferred events
+ *
+ * With it a widget which becomes visible again can refresh only what changed in the parts it
+ * shows instead of everything.
+ */
+class RangeUnionRefreshDeferrerAccumulator: public TypedRefreshDeferrerAccumulator<RefreshRanges>
+{
+private:
+    RefreshRanges ranges;
+
+protected:
+    void accumulateTyped(const RefreshRanges &params) override
+    {
+        ranges.unite(params);
+    }
+
+    void clear() override
+    {
+        ranges = RefreshRanges();
+    }
+
+    const RefreshRanges &typedResult() override
+    {
+        return ranges;
+    }
+};
+
 /**
  * @brief Helper class for deferred refreshing in Widgets
  *
@@ -145,6 +210,16 @@ public:
     ~RefreshDeferrer() override;
 
     bool attemptRefresh(RefreshDeferrerParams params);
+
+    /**
+     * @brief attemptRefresh() for accumulators derived from TypedRefreshDeferrerAccumulator<T>
+     */
+    template<class T>
+    bool attemptRefreshWith(const T &params)
+    {
+        return attemptRefresh(new T(params));
+    }
+
     void registerFor(CutterDockWidget *dockWidget);
 
 signals:
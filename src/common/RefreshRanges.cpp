@@ -0,0 +1,69 @@
+#include "common/RefreshRanges.h"
+
+#include <algorithm>
+
+RefreshRanges::RefreshRanges(Kinds kinds, RVA from, RVA to)
+    : kinds(kinds)
+{
+    if (from < to) {
+        ranges.append(Range(from, to));
+    }
+}
+
+RefreshRanges::RefreshRanges(Kinds kinds, RVA addr)
+    : RefreshRanges(kinds, addr, addr == RVA_MAX ? RVA_MAX : addr + 1)
+{
+}
+
+RefreshRanges RefreshRanges::everywhere(Kinds kinds)
+{
+    return RefreshRanges(kinds, 0, RVA_MAX);
+}
+
+void RefreshRanges::unite(const RefreshRanges &other)
+{
+    kinds |= other.kinds;
+    for (const Range &range : other.ranges) {
+        insert(range);
+    }
+}
+
+void RefreshRanges::insert(const Range &range)
+{
+    // First range that does not end before the new one starts, adjacent ones are merged
+    auto it = std::lower_bound(ranges.begin(), ranges.end(), range.first,
+    [](const Range &existing, RVA from) {
+        return existing.second < from;
+    });
+    Range merged = range;
+    auto last = it;
+    while (last != ranges.end() && last->first <= merged.second) {
+        merged.first = qMin(merged.first, last->first);
+        merged.second = qMax(merged.second, last->second);
+        ++last;
+    }
+    int index = static_cast<int>(it - ranges.begin());
+    ranges.erase(it, last);
+    ranges.insert(index, merged);
+
+    while (ranges.size() > maxRanges) {
+        int closest = 0;
+        for (int i = 1; i + 1 < ranges.size(); i++) {
+            if (ranges[i + 1].first - ranges[i].second
+                    < ranges[closest + 1].first - ranges[closest].second) {
+                closest = i;
+            }
+        }
+        ranges[closest].second = ranges[closest + 1].second;
+        ranges.remove(closest + 1);
+    }
+}
+
+bool RefreshRanges::intersects(RVA from, RVA to) const
+{
+    auto it = std::upper_bound(ranges.constBegin(), ranges.constEnd(), from,
+    [](RVA from, const Range &range) {
+        return from < range.second;
+    });
+    return it != ranges.constEnd() && it->first < to;
+}
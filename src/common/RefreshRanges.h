@@ -0,0 +1,69 @@
+#ifndef REFRESHRANGES_H
+#define REFRESHRANGES_H
+
+#include "core/CutterCommon.h"
+
+#include <QFlags>
+#include <QPair>
+#include <QVector>
+
+/**
+ * @brief What changed while a widget could not refresh: kinds of data and the address ranges
+ *
+ * Ranges are kept sorted and disjoint. Changes without a known address cover the whole
+ * address space, and once there are more than maxRanges ranges the closest ones are merged,
+ * so the union stays small however many events were deferred.
+ */
+class RefreshRanges
+{
+public:
+    enum Kind {
+        Bytes = 1 << 0,
+        Comments = 1 << 1,
+        Flags = 1 << 2,
+        Functions = 1 << 3
+    };
+    Q_DECLARE_FLAGS(Kinds, Kind)
+
+    using Range = QPair<RVA, RVA>; //!< From the first address up to, excluding, the second
+
+    static const int maxRanges = 64;
+
+    RefreshRanges() = default;
+
+    /**
+     * @brief Change of kinds in [from, to)
+     */
+    RefreshRanges(Kinds kinds, RVA from, RVA to);
+
+    /**
+     * @brief Change of kinds at a single address
+     */
+    RefreshRanges(Kinds kinds, RVA addr);
+
+    /**
+     * @brief Change of kinds anywhere
+     */
+    static RefreshRanges everywhere(Kinds kinds);
+
+    void unite(const RefreshRanges &other);
+
+    bool isEmpty() const                    { return !kinds; }
+    Kinds getKinds() const                  { return kinds; }
+    const QVector<Range> &getRanges() const { return ranges; }
+
+    /**
+     * @brief Whether anything changed in [from, to)
+     */
+    bool intersects(RVA from, RVA to) const;
+
+private:
+    Kinds kinds;
+    QVector<Range> ranges;
+
+    void insert(const Range &range);
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(RefreshRanges::Kinds)
+
+#endif // REFRESHRANGES_H
@@ -0,0 +1,178 @@
+#include "common/RefreshScheduler.h"
+#include "core/Cutter.h"
+#include "widgets/CutterDockWidget.h"
+
+#include <QAtomicInt>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTimer>
+
+// Milliseconds of applies per frame, leaving the rest of a 60 Hz frame to the event loop
+static const qint64 frameBudget = 8;
+
+namespace {
+
+class FetchTask : public AsyncTask
+{
+public:
+    explicit FetchTask(const std::function<void()> &fetch)
+        : fetch(fetch) {}
+
+    QString getTitle() override
+    {
+        return QCoreApplication::translate("RefreshScheduler", "Refreshing");
+    }
+
+    /**
+     * @brief Make sure the fetch never runs, so a replacement can not run at the same time
+     * @return false if it already started
+     */
+    bool cancel()
+    {
+        return state.testAndSetOrdered(Queued, Cancelled);
+    }
+
+protected:
+    void runTask() override
+    {
+        if (state.testAndSetOrdered(Queued, Started)) {
+            fetch();
+        }
+    }
+
+private:
+    enum { Queued, Started, Cancelled };
+
+    std::function<void()> fetch;
+    QAtomicInt state { Queued };
+};
+
+}
+
+RefreshScheduler::RefreshScheduler(QObject *parent)
+    : QObject(parent)
+{
+}
+
+RefreshScheduler::~RefreshScheduler()
+{
+    for (const Job &job : jobs) {
+        if (job.task) {
+            job.task->interrupt();
+        }
+    }
+}
+
+void RefreshScheduler::enqueue(CutterDockWidget *widget, const std::function<void()> &fetch,
+                               const std::function<void()> &apply)
+{
+    if (!watched.contains(widget)) {
+        watched.insert(widget);
+        connect(widget, &CutterDockWidget::becameVisibleToUser, this, [this, widget]() {
+            widgetShown(widget);
+        });
+        connect(widget, &QObject::destroyed, this, [this, widget]() {
+            widgetDestroyed(widget);
+        });
+    }
+
+    // A running fetch of the replaced job is superseded by the new one or its result dropped
+    ready.removeAll(widget);
+    jobs[widget] = Job { fetch, apply, AsyncTask::Ptr(), !fetch, ++nextSerial };
+    if (fetch) {
+        startFetch(widget);
+    } else {
+        widgetShown(widget);
+    }
+}
+
+void RefreshScheduler::startFetch(CutterDockWidget *widget)
+{
+    Job &job = jobs[widget];
+    // A finished signal of the task this one replaces must not count as its result
+    job.serial = ++nextSerial;
+    job.task = AsyncTask::Ptr(new FetchTask(job.fetch));
+    // Hidden widgets are only prefetched, nobody is looking at them yet
+    job.task->setPriority(widget->isVisibleToUser() ? AsyncTask::Priority::Normal
+                          : AsyncTask::Priority::Background);
+    job.task->setSupersedeKey(widget, QStringLiteral("refreshScheduler"));
+    quint64 serial = job.serial;
+    connect(job.task.data(), &AsyncTask::finished, this, [this, widget, serial]() {
+        fetchFinished(widget, serial);
+    }, Qt::QueuedConnection);
+    Core()->getAsyncTaskManager()->start(job.task);
+}
+
+void RefreshScheduler::fetchFinished(CutterDockWidget *widget, quint64 serial)
+{
+    auto it = jobs.find(widget);
+    if (it == jobs.end() || it->serial != serial) {
+        // Replaced or the widget is gone
+        return;
+    }
+    it->task.clear();
+    it->fetched = true;
+    widgetShown(widget);
+}
+
+void RefreshScheduler::widgetShown(CutterDockWidget *widget)
+{
+    auto it = jobs.find(widget);
+    if (it == jobs.end() || !widget->isVisibleToUser()) {
+        return;
+    }
+    if (!it->fetched) {
+        if (it->task && it->task->getPriority() == AsyncTask::Priority::Background
+                && static_cast<FetchTask *>(it->task.data())->cancel()) {
+            // Still queued as a prefetch, now the user waits for it
+            startFetch(widget);
+        }
+        return;
+    }
+    if (!ready.contains(widget)) {
+        ready.append(widget);
+    }
+    scheduleFrame();
+}
+
+void RefreshScheduler::widgetDestroyed(CutterDockWidget *widget)
+{
+    auto it = jobs.find(widget);
+    if (it != jobs.end()) {
+        if (it->task) {
+            it->task->interrupt();
+        }
+        jobs.erase(it);
+    }
+    ready.removeAll(widget);
+    watched.remove(widget);
+}
+
+void RefreshScheduler::scheduleFrame()
+{
+    if (frameScheduled) {
+        return;
+    }
+    frameScheduled = true;
+    QTimer::singleShot(0, this, &RefreshScheduler::runFrame);
+}
+
+void RefreshScheduler::runFrame()
+{
+    frameScheduled = false;
+    QElapsedTimer timer;
+    timer.start();
+    // At least one apply per frame, a single one taking longer can not be split anyway
+    while (!ready.isEmpty()) {
+        CutterDockWidget *widget = ready.takeFirst();
+        // Taken out first, as apply may schedule the widget again
+        Job job = jobs.take(widget);
+        job.apply();
+        if (timer.elapsed() >= frameBudget) {
+            break;
+        }
+    }
+    if (!ready.isEmpty()) {
+        scheduleFrame();
+    }
+}
@@ -0,0 +1,87 @@
+#ifndef REFRESHSCHEDULER_H
+#define REFRESHSCHEDULER_H
+
+#include "common/AsyncTask.h"
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QSet>
+
+#include <functional>
+#include <memory>
+
+class CutterDockWidget;
+
+/**
+ * @brief Spreads the refreshes of many widgets over several frames
+ *
+ * A refresh is split into a fetch, which gets the data from r2 in a background task, and an
+ * apply, which puts it into the widget on the UI thread. Applies run in frames of at most
+ * frameBudget milliseconds with the event loop running in between, so a refreshAll() reaching
+ * every widget does not freeze the UI until all of them are done. Widgets visible to the user
+ * are fetched first, hidden ones are prefetched in the background and only applied once they
+ * are shown. Scheduling a widget again replaces its pending refresh.
+ */
+class RefreshScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit RefreshScheduler(QObject *parent = nullptr);
+    ~RefreshScheduler() override;
+
+    /**
+     * @brief Refresh widget with the result of fetch
+     * @param fetch runs in another thread and must not touch the widget
+     * @param apply runs on the UI thread, only while the widget exists and is visible
+     */
+    template<class T>
+    void schedule(CutterDockWidget *widget, const std::function<T()> &fetch,
+                  const std::function<void(const T &)> &apply)
+    {
+        auto result = std::make_shared<T>();
+        enqueue(widget, [fetch, result]() {
+            *result = fetch();
+        }, [apply, result]() {
+            apply(*result);
+        });
+    }
+
+    /**
+     * @brief Refresh widget without fetching anything in the background
+     */
+    void schedule(CutterDockWidget *widget, const std::function<void()> &apply)
+    {
+        enqueue(widget, nullptr, apply);
+    }
+
+private:
+    struct Job {
+        std::function<void()> fetch;
+        std::function<void()> apply;
+        AsyncTask::Ptr task;
+        bool fetched;
+        quint64 serial; //!< Tells results of replaced jobs apart
+    };
+
+    QHash<CutterDockWidget *, Job> jobs;
+    /**
+     * Widgets whose job is fetched and which are visible, in the order they are applied
+     */
+    QList<CutterDockWidget *> ready;
+    QSet<CutterDockWidget *> watched;
+    quint64 nextSerial = 0;
+    bool frameScheduled = false;
+
+    void enqueue(CutterDockWidget *widget, const std::function<void()> &fetch,
+                 const std::function<void()> &apply);
+    void startFetch(CutterDockWidget *widget);
+    void fetchFinished(CutterDockWidget *widget, quint64 serial);
+    void widgetShown(CutterDockWidget *widget);
+    void widgetDestroyed(CutterDockWidget *widget);
+    void scheduleFrame();
+    void runFrame();
+};
+
+#endif // REFRESHSCHEDULER_H
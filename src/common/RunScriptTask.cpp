@@ -11,12 +11,6 @@ RunScriptTask::~RunScriptTask()
 {
 }
 
-void RunScriptTask::interrupt()
-{
-    AsyncTask::interrupt();
-    r_cons_singleton()->context->breaked = true;
-}
-
 void RunScriptTask::runTask()
 {
     if (!this->fileName.isNull()) {
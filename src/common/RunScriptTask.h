@@ -20,8 +20,6 @@ public:
         this->fileName = fileName;
     }
 
-    void interrupt() override;
-
 protected:
     void runTask() override;
 
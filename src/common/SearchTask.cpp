@@ -0,0 +1,94 @@
+#include "common/SearchTask.h"
+
+#include <algorithm>
+
+// Searching for code disassembles every address, so those chunks are kept smaller
+static const RVA dataChunkSize = 8 * 1024 * 1024;
+static const RVA codeChunkSize = 256 * 1024;
+static const RVA chunkOverlap = 4096;
+
+SearchTask::SearchTask(const QString &searchFor, const QString &space, const QList<Range> &ranges,
+                       int maxHits)
+    : ranges(ranges),
+      searchFor(searchFor),
+      space(space),
+      maxHits(maxHits)
+{
+    setProgressUnit(tr("bytes"));
+}
+
+QList<SearchTask::Range> SearchTask::rangesFrom(const QList<Range> &ranges, RVA address)
+{
+    QList<Range> ret;
+    for (const Range &range : ranges) {
+        if (range.second <= address) {
+            continue;
+        }
+        ret << Range(qMax(range.first, address), range.second);
+    }
+    return ret;
+}
+
+qint64 SearchTask::totalSize() const
+{
+    qint64 total = 0;
+    for (const Range &range : ranges) {
+        total += static_cast<qint64>(range.second - range.first);
+    }
+    return total;
+}
+
+bool SearchTask::reportHits(QList<SearchDescription> found, RVA from, RVA end)
+{
+    // In order, so the hits before a resume address are exactly the ones reported
+    std::sort(found.begin(), found.end(), [](const SearchDescription &a, const SearchDescription &b) {
+        return a.offset < b.offset;
+    });
+    QList<SearchDescription> hits;
+    for (const SearchDescription &hit : found) {
+        if (hit.offset < from || hit.offset >= end) {
+            // Found by the previous or next chunk
+            continue;
+        }
+        if (hitCount >= maxHits) {
+            if (!hits.isEmpty()) {
+                emit hitsFound(hits);
+            }
+            emit hitLimitReached(hit.offset);
+            return false;
+        }
+        hits << hit;
+        hitCount++;
+    }
+    if (!hits.isEmpty()) {
+        emit hitsFound(hits);
+    }
+    return true;
+}
+
+void SearchTask::runTask()
+{
+    const bool code = space == "/cj" || space == "/Rj";
+    const RVA chunkSize = code ? codeChunkSize : dataChunkSize;
+    // A hit can not be longer than what is searched for, plus some instructions for code
+    const RVA overlap = qMax<RVA>(chunkOverlap, static_cast<RVA>(searchFor.size()) * 2);
+
+    qint64 total = totalSize();
+    qint64 done = 0;
+    setProgress(0, total);
+
+    for (const Range &range : ranges) {
+        for (RVA from = range.first; from < range.second; from += chunkSize) {
+            if (isInterrupted()) {
+                return;
+            }
+            RVA end = qMin(range.second, from + chunkSize);
+            RVA to = qMin(range.second, end + overlap);
+            if (!reportHits(Core()->getAllSearch(searchFor, space, from, to), from, end)) {
+                return;
+            }
+            done += static_cast<qint64>(end - from);
+            setProgress(done, total);
+        }
+    }
+}
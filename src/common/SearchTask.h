@@ -0,0 +1,67 @@
+#ifndef SEARCHTASK_H
+#define SEARCHTASK_H
+
+#include "common/AsyncTask.h"
+#include "core/Cutter.h"
+
+#include <QPair>
+
+/**
+ * @brief Runs a search range by range and streams the hits while it goes
+ *
+ * The ranges are split into chunks, each searched with its own command, so hits show up
+ * while the rest of the address space is still being searched, progress follows the
+ * covered addresses and an interruption takes effect after the current chunk. Chunks
+ * overlap a little so hits crossing a chunk end are still found, but each hit is only
+ * reported by the chunk it starts in.
+ */
+class SearchTask : public AsyncTask
+{
+    Q_OBJECT
+
+public:
+    using Range = QPair<RVA, RVA>;
+
+    /**
+     * @param maxHits stop after this many hits, see hitLimitReached()
+     */
+    SearchTask(const QString &searchFor, const QString &space, const QList<Range> &ranges,
+               int maxHits);
+
+    QString getTitle() override                     { return tr("Searching for %1").arg(searchFor); }
+
+    /**
+     * @brief The parts of ranges at or after address
+     */
+    static QList<Range> rangesFrom(const QList<Range> &ranges, RVA address);
+
+signals:
+    void hitsFound(const QList<SearchDescription> &hits);
+
+    /**
+     * @brief Emitted instead of searching further after maxHits hits
+     * @param resumeAddress where a continued search has to start
+     */
+    void hitLimitReached(RVA resumeAddress);
+
+protected:
+    void runTask() override;
+
+    QList<Range> ranges;
+
+    qint64 totalSize() const;
+
+    /**
+     * @brief Emit the hits in found which start in [from, end), in address order
+     * @return false if the hit limit was reached and the search has to stop
+     */
+    bool reportHits(QList<SearchDescription> found, RVA from, RVA end);
+
+private:
+    QString searchFor;
+    QString space;
+    int maxHits;
+    int hitCount = 0;
+};
+
+#endif // SEARCHTASK_H
@@ -0,0 +1,91 @@
+#include "common/SectionEntropyProvider.h"
+#include "common/EntropyMapProvider.h"
+
+// Files and patch states whose section entropy is kept
+static const int cachedFiles = 8;
+
+SectionEntropyProvider::SectionEntropyProvider(QObject *parent)
+    : QObject(parent),
+      cache(cachedFiles)
+{
+    connect(Core(), &CutterCore::refreshAll, this, &SectionEntropyProvider::updateFile);
+    connect(Core(), &CutterCore::instructionChanged, this, &SectionEntropyProvider::bytesPatched);
+}
+
+SectionEntropyProvider::~SectionEntropyProvider()
+{
+    for (auto &task : tasks) {
+        task->interrupt();
+    }
+}
+
+void SectionEntropyProvider::updateFile()
+{
+    QString key = EntropyMapProvider::fileKey();
+    if (key == currentFileKey) {
+        return;
+    }
+    currentFileKey = key;
+    // Results of the previous file are not wanted anymore
+    for (auto &task : tasks) {
+        task->interrupt();
+    }
+    tasks.clear();
+}
+
+void SectionEntropyProvider::bytesPatched()
+{
+    QString oldKey = currentFileKey;
+    updateFile();
+    if (currentFileKey != oldKey && !requested.isEmpty()) {
+        request(requested);
+        // Shown entropy is outdated until the new one is computed
+        emit entropyChanged();
+    }
+}
+
+QString SectionEntropyProvider::getEntropy(RVA paddr, RVA size) const
+{
+    const QHash<Range, QString> *cached = cache.object(currentFileKey);
+    return cached ? cached->value(Range(paddr, size)) : QString();
+}
+
+void SectionEntropyProvider::request(const QList<SectionDescription> &sections)
+{
+    updateFile();
+    requested = sections;
+    const QHash<Range, QString> *cached = cache.object(currentFileKey);
+    for (const SectionDescription &section : sections) {
+        Range range(section.paddr, section.size);
+        if (!section.size || (cached && cached->contains(range)) || tasks.contains(range)) {
+            continue;
+        }
+        QSharedPointer<SectionEntropyTask> task(new SectionEntropyTask(section.paddr, section.size));
+        connect(task.data(), &SectionEntropyTask::entropyComputed,
+                this, &SectionEntropyProvider::entropyComputed);
+        tasks.insert(range, task);
+        Core()->getAsyncTaskManager()->start(task);
+    }
+}
+
+void SectionEntropyProvider::entropyComputed(RVA paddr, RVA size, const QString &entropy)
+{
+    Range range(paddr, size);
+    auto it = tasks.find(range);
+    if (it == tasks.end() || it.value().data() != sender()) {
+        // Superseded, e.g. by opening another file
+        return;
+    }
+    tasks.erase(it);
+    if (entropy.isEmpty()) {
+        // Could not be read, try again with the next request
+        return;
+    }
+    QHash<Range, QString> *cached = cache.object(currentFileKey);
+    if (!cached) {
+        cached = new QHash<Range, QString>();
+        cache.insert(currentFileKey, cached);
+    }
+    cached->insert(range, entropy);
+    emit entropyChanged();
+}
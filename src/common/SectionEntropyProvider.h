@@ -0,0 +1,59 @@
+#ifndef SECTIONENTROPYPROVIDER_H
+#define SECTIONENTROPYPROVIDER_H
+
+#include "common/SectionEntropyTask.h"
+#include "core/CutterDescriptions.h"
+
+#include <QObject>
+#include <QCache>
+#include <QHash>
+#include <QPair>
+
+/**
+ * @brief Asynchronous, cached entropy of the sections of the opened file
+ *
+ * CutterCore::getAllSections() only fills in entropy which is already cached here.
+ * Widgets that show it call request() and update themselves on entropyChanged().
+ * Results are cached per file (see EntropyMapProvider::fileKey()), so refreshing or
+ * reopening the same file does not hash its sections again. After a patch, the sections
+ * requested last are hashed again. Sections which could not be read are not cached.
+ */
+class SectionEntropyProvider : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SectionEntropyProvider(QObject *parent = nullptr);
+    ~SectionEntropyProvider() override;
+
+    /**
+     * @return the cached entropy of the given raw range or an empty string if not known yet
+     */
+    QString getEntropy(RVA paddr, RVA size) const;
+
+    /**
+     * @brief Start computing the entropy of all given sections which is not cached or pending
+     */
+    void request(const QList<SectionDescription> &sections);
+
+signals:
+    void entropyChanged();
+
+private:
+    using Range = QPair<RVA, RVA>;
+
+    QString currentFileKey;
+    /**
+     * Entropy by range per file key, only for the last few files and patch states
+     */
+    QCache<QString, QHash<Range, QString>> cache;
+    QHash<Range, QSharedPointer<SectionEntropyTask>> tasks;
+    QList<SectionDescription> requested;
+
+private slots:
+    void updateFile();
+    void bytesPatched();
+    void entropyComputed(RVA paddr, RVA size, const QString &entropy);
+};
+
+#endif // SECTIONENTROPYPROVIDER_H
@@ -0,0 +1,40 @@
+#include "common/SectionEntropyTask.h"
+#include "common/EntropyTask.h"
+#include "common/CorePool.h"
+
+#include <cstring>
+
+static const int readChunkSize = 64 * 1024;
+
+SectionEntropyTask::SectionEntropyTask(RVA paddr, RVA size)
+    : paddr(paddr),
+      size(size)
+{
+    setPriority(Priority::Background);
+    setProgressUnit(tr("bytes"));
+}
+
+void SectionEntropyTask::runTask()
+{
+    quint32 hist[256];
+    memset(hist, 0, sizeof(hist));
+    setProgress(0, static_cast<qint64>(size));
+    for (RVA offset = 0; offset < size; offset += readChunkSize) {
+        if (isInterrupted()) {
+            return;
+        }
+        int len = static_cast<int>(qMin<RVA>(readChunkSize, size - offset));
+        // The core is only locked while reading, hashing runs in parallel with other sections
+        QByteArray data = Core()->getCorePool()->ioRead(paddr + offset, len, true);
+        if (data.isEmpty()) {
+            // The entropy of a part of the section would be wrong, not just incomplete
+            emit entropyComputed(paddr, size, QString());
+            return;
+        }
+        EntropyTask::byteHistogram(reinterpret_cast<const uchar *>(data.constData()),
+                                   static_cast<size_t>(data.size()), hist);
+        setProgress(static_cast<qint64>(offset) + data.size(), static_cast<qint64>(size));
+    }
+    EntropyBucket bucket = EntropyTask::bucketFromHistogram(hist);
+    emit entropyComputed(paddr, size, QString::number(bucket.entropy, 'f', 8));
+}
@@ -0,0 +1,35 @@
+#ifndef SECTIONENTROPYTASK_H
+#define SECTIONENTROPYTASK_H
+
+#include "common/AsyncTask.h"
+#include "core/Cutter.h"
+
+/**
+ * @brief Computes the entropy of the raw bytes of one section, as `iS entropy` does
+ *
+ * One task is started per section, so the sections are hashed in parallel on the task pool.
+ */
+class SectionEntropyTask : public AsyncTask
+{
+    Q_OBJECT
+
+public:
+    SectionEntropyTask(RVA paddr, RVA size);
+
+    QString getTitle() override                     { return tr("Computing section entropy"); }
+
+signals:
+    /**
+     * @param entropy empty if the section could not be read completely
+     */
+    void entropyComputed(RVA paddr, RVA size, const QString &entropy);
+
+protected:
+    void runTask() override;
+
+private:
+    RVA paddr;
+    RVA size;
+};
+
+#endif // SECTIONENTROPYTASK_H
@@ -0,0 +1,236 @@
+#include "common/StallDetector.h"
+#include "common/Configuration.h"
+#include "core/Cutter.h"
+
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QEvent>
+#include <QMessageBox>
+#include <QMetaEnum>
+#include <QMutex>
+#include <QThread>
+#include <QWaitCondition>
+
+// Milliseconds between two beats of the UI thread
+static const int heartbeatInterval = 100;
+
+// Deeper scopes are counted but not recorded
+static const int maxDepth = 32;
+
+namespace {
+
+struct Frame {
+    const char *command;
+    const QMetaObject *receiverClass;
+    int eventType;
+    qint64 started;
+};
+
+QElapsedTimer uptime;
+QAtomicInteger<qint64> lastBeat;
+QAtomicInt enabled;
+QThread *uiThread = nullptr;
+
+QMutex framesMutex;
+Frame frames[maxDepth];
+int depth = 0;
+
+QString eventName(int type)
+{
+    if (type == QEvent::MetaCall) {
+        return QStringLiteral("queued call");
+    }
+    const char *key = QMetaEnum::fromType<QEvent::Type>().valueToKey(type);
+    return key ? QString::fromLatin1(key) : QStringLiteral("event %1").arg(type);
+}
+
+/**
+ * What the UI thread is doing, outermost scope first
+ */
+QString describeActivity()
+{
+    QMutexLocker locker(&framesMutex);
+    qint64 now = uptime.elapsed();
+    QStringList lines;
+    for (int i = 0; i < qMin(depth, maxDepth); i++) {
+        const Frame &frame = frames[i];
+        QString what;
+        if (frame.command) {
+            what = QStringLiteral("r2 command \"%1\"").arg(QString::fromUtf8(frame.command));
+        } else {
+            QString receiver = frame.receiverClass ? QString::fromLatin1(frame.receiverClass->className())
+                                                   : QStringLiteral("nothing");
+            what = QStringLiteral("%1 to %2").arg(eventName(frame.eventType), receiver);
+        }
+        lines.append(QStringLiteral("%1 for %2 ms").arg(what).arg(now - frame.started));
+    }
+    if (depth > maxDepth) {
+        lines.append(QStringLiteral("%1 more nested").arg(depth - maxDepth));
+    }
+    return lines.isEmpty() ? QStringLiteral("outside of any event or r2 command") : lines.join('\n');
+}
+
+}
+
+/**
+ * @brief Checks the heartbeat of the UI thread and records what it does when it stops
+ */
+class StallWatchdog : public QThread
+{
+public:
+    explicit StallWatchdog(qint64 threshold)
+        : threshold(threshold) {}
+
+    void stop()
+    {
+        QMutexLocker locker(&mutex);
+        stopping = true;
+        stopCondition.wakeAll();
+    }
+
+    /**
+     * @brief The activity recorded during the last stall, empty if it was not noticed
+     */
+    QString takeActivity()
+    {
+        QMutexLocker locker(&mutex);
+        QString ret = activity;
+        activity.clear();
+        return ret;
+    }
+
+protected:
+    void run() override
+    {
+        QMutexLocker locker(&mutex);
+        // Often enough to catch the UI thread within the first quarter of a stall
+        const unsigned long checkInterval = static_cast<unsigned long>(qMax<qint64>(threshold / 4, 10));
+        bool noticed = false;
+        while (!stopping) {
+            stopCondition.wait(&mutex, checkInterval);
+            if (stopping) {
+                break;
+            }
+            qint64 blocked = uptime.elapsed() - lastBeat.loadAcquire() - heartbeatInterval;
+            if (blocked < threshold) {
+                noticed = false;
+                continue;
+            }
+            if (!noticed) {
+                noticed = true;
+                activity = describeActivity();
+                // Written here as well, in case the UI thread never recovers
+                qWarning().noquote() << "UI thread blocked for more than" << blocked << "ms in:\n"
+                                     << activity;
+            }
+        }
+    }
+
+private:
+    const qint64 threshold;
+    QMutex mutex;
+    QWaitCondition stopCondition;
+    bool stopping = false;
+    QString activity;
+};
+
+StallDetector::StallDetector(QObject *parent)
+    : QObject(parent),
+      watchdog(nullptr)
+{
+    threshold = Config()->getStallThreshold();
+    if (threshold <= 0) {
+        return;
+    }
+    // Until the event loop runs, loading plugins, the main window and the file would all count
+    QTimer::singleShot(0, this, &StallDetector::start);
+}
+
+void StallDetector::start()
+{
+    uptime.start();
+    lastBeat.storeRelease(uptime.elapsed());
+    uiThread = thread();
+    enabled.storeRelease(1);
+
+    connect(&heartbeat, &QTimer::timeout, this, &StallDetector::beat);
+    heartbeat.start(heartbeatInterval);
+    watchdog = new StallWatchdog(threshold);
+    watchdog->start(QThread::LowPriority);
+}
+
+StallDetector::~StallDetector()
+{
+    enabled.storeRelease(0);
+    if (watchdog) {
+        watchdog->stop();
+        watchdog->wait();
+        delete watchdog;
+    }
+}
+
+void StallDetector::beat()
+{
+    qint64 now = uptime.elapsed();
+    qint64 blocked = now - lastBeat.fetchAndStoreOrdered(now) - heartbeatInterval;
+    if (blocked < threshold) {
+        return;
+    }
+    QString activity = watchdog->takeActivity();
+    if (activity.isEmpty()) {
+        activity = QStringLiteral("unknown");
+    }
+    Core()->message(tr("The user interface was blocked for %1 ms in:\n%2").arg(blocked).arg(activity));
+    emit stallDetected(blocked, activity);
+    if (Config()->getStallNotice()) {
+        showNotice(blocked, activity);
+    }
+}
+
+void StallDetector::showNotice(qint64 duration, const QString &activity)
+{
+    // Only one at a time, a later stall updates the open notice
+    if (!notice) {
+        notice = new QMessageBox(QMessageBox::Warning, tr("Cutter was not responding"), QString(),
+                                 QMessageBox::Close, QApplication::activeWindow());
+        notice->setAttribute(Qt::WA_DeleteOnClose);
+        notice->setModal(false);
+    }
+    notice->setText(tr("The user interface was blocked for %1 ms.").arg(duration));
+    notice->setDetailedText(activity);
+    notice->show();
+}
+
+StallDetector::Scope::Scope(const char *command)
+{
+    enter(command, nullptr, 0);
+}
+
+StallDetector::Scope::Scope(const QObject *receiver, const QEvent *event)
+{
+    enter(nullptr, receiver ? receiver->metaObject() : nullptr, event->type());
+}
+
+void StallDetector::Scope::enter(const char *command, const QMetaObject *receiverClass,
+                                 int eventType)
+{
+    active = enabled.loadAcquire() && QThread::currentThread() == uiThread;
+    if (!active) {
+        return;
+    }
+    QMutexLocker locker(&framesMutex);
+    if (depth < maxDepth) {
+        frames[depth] = Frame { command, receiverClass, eventType, uptime.elapsed() };
+    }
+    depth++;
+}
+
+StallDetector::Scope::~Scope()
+{
+    if (!active) {
+        return;
+    }
+    // Also keeps the command alive while the watchdog describes it
+    QMutexLocker locker(&framesMutex);
+    depth--;
+}
@@ -0,0 +1,75 @@
+#ifndef STALLDETECTOR_H
+#define STALLDETECTOR_H
+
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+
+class QEvent;
+class QMetaObject;
+class QMessageBox;
+class StallWatchdog;
+
+/**
+ * @brief Detects when the UI thread does not process events for too long and reports what it did
+ *
+ * A timer in the UI thread beats regularly and a watchdog thread checks the beats. When they
+ * stop for longer than the threshold, the watchdog takes a snapshot of the Scopes open in the
+ * UI thread, which tell which event was being delivered to which class and which r2 command
+ * was running. Once the UI thread runs again, the stall is logged with its duration and
+ * stallDetected() is emitted. A stall the UI never recovers from is still written to the
+ * debug output by the watchdog.
+ *
+ * Detection starts once the event loop of the application runs, so startup is not reported.
+ * The threshold is the setting "stall.threshold" in milliseconds, 0 disables detection, and
+ * "stall.notice" additionally shows a non-modal notice for every stall.
+ */
+class StallDetector : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Marks what the UI thread is doing while it exists, does nothing in other threads
+     * It only stores pointers, so it is cheap enough to wrap every event and r2 command.
+     */
+    class Scope
+    {
+    public:
+        /**
+         * @param command must stay valid while the scope exists
+         */
+        explicit Scope(const char *command);
+        Scope(const QObject *receiver, const QEvent *event);
+        ~Scope();
+
+    private:
+        bool active;
+
+        void enter(const char *command, const QMetaObject *receiverClass, int eventType);
+    };
+
+    explicit StallDetector(QObject *parent = nullptr);
+    ~StallDetector() override;
+
+signals:
+    /**
+     * @param duration milliseconds the UI thread was blocked
+     * @param activity what it was doing, outermost first, one per line
+     */
+    void stallDetected(qint64 duration, const QString &activity);
+
+private slots:
+    void start();
+    void beat();
+
+private:
+    qint64 threshold;
+    QTimer heartbeat;
+    StallWatchdog *watchdog;
+    QPointer<QMessageBox> notice;
+
+    void showNotice(qint64 duration, const QString &activity);
+};
+
+#endif // STALLDETECTOR_H
@@ -0,0 +1,259 @@
+#include "common/StringScanner.h"
+
+#include <QtAlgorithms>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define STRINGSCANNER_SSE2
+#include <emmintrin.h>
+#endif
+
+static inline bool isPrintable(uchar c)
+{
+    return (c >= 0x20 && c < 0x7f) || c == '\t';
+}
+
+#ifdef STRINGSCANNER_SSE2
+/**
+ * @brief Bit i is set if byte i of the 16 bytes at data is printable
+ */
+static inline unsigned printableMask(__m128i v)
+{
+    // c - 0x20 < 0x5f compared unsigned, which SSE2 can only do after shifting into the signed range
+    __m128i shifted = _mm_add_epi8(v, _mm_set1_epi8(0x60));
+    __m128i printable = _mm_or_si128(_mm_cmplt_epi8(shifted, _mm_set1_epi8(-33)),
+                                     _mm_cmpeq_epi8(v, _mm_set1_epi8('\t')));
+    return static_cast<unsigned>(_mm_movemask_epi8(printable));
+}
+
+static inline __m128i load(const uchar *data)
+{
+    return _mm_loadu_si128(reinterpret_cast<const __m128i *>(data));
+}
+#endif
+
+/**
+ * @brief Number of printable ASCII bytes at the start of data
+ */
+static int printableRunLength(const uchar *data, int size)
+{
+    int i = 0;
+#ifdef STRINGSCANNER_SSE2
+    for (; i + 16 <= size; i += 16) {
+        unsigned mask = printableMask(load(data + i));
+        if (mask != 0xffff) {
+            return i + static_cast<int>(qCountTrailingZeroBits(~mask));
+        }
+    }
+#endif
+    while (i < size && isPrintable(data[i])) {
+        i++;
+    }
+    return i;
+}
+
+/**
+ * @brief Number of UTF-16 characters at the start of data consisting of a printable byte and a zero
+ */
+static int wideRunLength(const uchar *data, int size, bool bigEndian)
+{
+    int i = 0;
+#ifdef STRINGSCANNER_SSE2
+    const unsigned printableBits = bigEndian ? 0xaaaa : 0x5555;
+    for (; i + 16 <= size; i += 16) {
+        __m128i v = load(data + i);
+        unsigned zero = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_setzero_si128())));
+        unsigned valid = (printableMask(v) & printableBits) | (zero & ~printableBits & 0xffff);
+        if (valid != 0xffff) {
+            // Only whole characters before the first invalid byte count
+            return (i + static_cast<int>(qCountTrailingZeroBits(~valid))) / 2;
+        }
+    }
+#endif
+    int lo = bigEndian ? 1 : 0;
+    while (i + 1 < size && isPrintable(data[i + lo]) && data[i + 1 - lo] == 0) {
+        i += 2;
+    }
+    return i / 2;
+}
+
+/**
+ * @brief Offset of the first byte which may start a string
+ */
+static int skipToCandidate(const uchar *data, int size, bool high)
+{
+    int i = 0;
+#ifdef STRINGSCANNER_SSE2
+    for (; i + 16 <= size; i += 16) {
+        __m128i v = load(data + i);
+        unsigned mask = printableMask(v);
+        if (high) {
+            mask |= static_cast<unsigned>(_mm_movemask_epi8(v));
+        }
+        if (mask) {
+            return i + static_cast<int>(qCountTrailingZeroBits(mask));
+        }
+    }
+#endif
+    while (i < size && !isPrintable(data[i]) && !(high && data[i] >= 0x80)) {
+        i++;
+    }
+    return i;
+}
+
+/**
+ * @brief Length of the UTF-8 sequence of a printable non-ASCII character at data, 0 if there is none
+ */
+static int utf8SequenceLength(const uchar *data, int size)
+{
+    static const uint minCodePoint[] = { 0, 0, 0x80, 0x800, 0x10000 };
+
+    uchar c = data[0];
+    int len;
+    uint codePoint;
+    if (c >= 0xc2 && c <= 0xdf) {
+        len = 2;
+        codePoint = c & 0x1f;
+    } else if (c >= 0xe0 && c <= 0xef) {
+        len = 3;
+        codePoint = c & 0x0f;
+    } else if (c >= 0xf0 && c <= 0xf4) {
+        len = 4;
+        codePoint = c & 0x07;
+    } else {
+        return 0;
+    }
+    if (len > size) {
+        return 0;
+    }
+    for (int i = 1; i < len; i++) {
+        if ((data[i] & 0xc0) != 0x80) {
+            return 0;
+        }
+        codePoint = (codePoint << 6) | (data[i] & 0x3f);
+    }
+    // Overlong forms, surrogates, C1 controls and values beyond Unicode are no text
+    if (codePoint < minCodePoint[len] || codePoint < 0xa0
+            || (codePoint >= 0xd800 && codePoint < 0xe000) || codePoint > 0x10ffff) {
+        return 0;
+    }
+    return len;
+}
+
+StringScanner::StringScanner(int minLength, Encodings encodings)
+    : minLength(qMax(minLength, 1)),
+      encodings(encodings)
+{
+}
+
+void StringScanner::scan(const uchar *data, int size, RVA vaddr, const QString &section,
+                         StringTable *out, int begin, int end) const
+{
+    if (end < 0 || end > size) {
+        end = size;
+    }
+    const bool narrow = encodings & (Ascii | Utf8);
+    const bool high = encodings & Utf8;
+    auto at = [vaddr](int offset) {
+        return vaddr == RVA_INVALID ? RVA_INVALID : vaddr + offset;
+    };
+    // Strings starting in the context before begin are only scanned to skip them
+    auto target = [out, begin](int start) {
+        return start >= begin ? out : nullptr;
+    };
+    int i = 0;
+    int previousEnd = 0;
+    while (i < size) {
+        i += skipToCandidate(data + i, size - i, high);
+        if (i >= end) {
+            break;
+        }
+        int consumed = 0;
+        if (encodings & Utf16LE) {
+            consumed = scanWide(data + i, size - i, false, at(i), section, target(i));
+        }
+        // A UTF-16BE string starts at the zero byte before its first character
+        if (!consumed && (encodings & Utf16BE) && i > previousEnd && data[i - 1] == 0) {
+            consumed = scanWide(data + i - 1, size - i + 1, true, at(i - 1), section, target(i - 1));
+            if (consumed) {
+                consumed--;
+            }
+        }
+        if (!consumed && narrow) {
+            consumed = scanNarrow(data + i, size - i, at(i), section, target(i));
+        }
+        i += qMax(consumed, 1);
+        previousEnd = i;
+    }
+}
+
+int StringScanner::scanNarrow(const uchar *data, int size, RVA vaddr, const QString &section,
+                              StringTable *out) const
+{
+    static const QString asciiType = QStringLiteral("ascii");
+    static const QString utf8Type = QStringLiteral("utf8");
+
+    const bool utf8 = encodings & Utf8;
+    int i = 0;
+    int chars = 0;
+    // The part of the run up to maxStringSize, which is reported
+    int kept = 0;
+    int keptChars = 0;
+    bool ascii = true;
+    while (i < size) {
+        int run = printableRunLength(data + i, size - i);
+        if (kept == i) {
+            int take = qMin(run, maxStringSize - kept);
+            kept += take;
+            keptChars += take;
+        }
+        i += run;
+        chars += run;
+        if (!utf8 || i >= size) {
+            break;
+        }
+        int len = utf8SequenceLength(data + i, size - i);
+        if (!len) {
+            break;
+        }
+        if (kept == i && kept + len <= maxStringSize) {
+            kept += len;
+            keptChars++;
+            ascii = false;
+        }
+        i += len;
+        chars++;
+    }
+    if (chars < minLength || !out) {
+        return i;
+    }
+
+    // Both ASCII and the validated sequences already are UTF-8, so the bytes are stored as they are
+    out->append(vaddr, reinterpret_cast<const char *>(data), kept, ascii ? asciiType : utf8Type,
+                section, static_cast<ut32>(keptChars), static_cast<ut32>(kept));
+    return i;
+}
+
+int StringScanner::scanWide(const uchar *data, int size, bool bigEndian, RVA vaddr,
+                            const QString &section, StringTable *out) const
+{
+    static const QString leType = QStringLiteral("utf16le");
+    static const QString beType = QStringLiteral("utf16be");
+
+    int chars = wideRunLength(data, size, bigEndian);
+    if (chars < minLength) {
+        return 0;
+    }
+    if (!out) {
+        return 2 * chars;
+    }
+
+    int keptChars = qMin(chars, maxStringSize / 2);
+    QByteArray string(keptChars, Qt::Uninitialized);
+    int lo = bigEndian ? 1 : 0;
+    for (int i = 0; i < keptChars; i++) {
+        string[i] = static_cast<char>(data[2 * i + lo]);
+    }
+    out->append(vaddr, string.constData(), string.size(), bigEndian ? beType : leType, section,
+                static_cast<ut32>(keptChars), static_cast<ut32>(2 * keptChars));
+    return 2 * chars;
+}
@@ -0,0 +1,61 @@
+#ifndef STRINGSCANNER_H
+#define STRINGSCANNER_H
+
+#include "common/CompactTables.h"
+
+#include <QFlags>
+
+/**
+ * @brief Finds printable strings in raw bytes, like izz but without going through JSON
+ *
+ * Runs of printable ASCII (optionally mixed with valid UTF-8 sequences), UTF-16LE and
+ * UTF-16BE are detected and appended to a StringTable. The printable run detection works on
+ * 16 bytes at once where SSE2 is available. A scanner has no mutable state, so one instance
+ * can scan several buffers in parallel.
+ */
+class StringScanner
+{
+public:
+    enum Encoding {
+        Ascii = 1 << 0,
+        Utf8 = 1 << 1, //!< Implies Ascii
+        Utf16LE = 1 << 2,
+        Utf16BE = 1 << 3,
+        AllEncodings = Ascii | Utf8 | Utf16LE | Utf16BE
+    };
+    Q_DECLARE_FLAGS(Encodings, Encoding)
+
+    /**
+     * @brief Strings longer than this many bytes are cut, the rest of their run is skipped
+     */
+    static const int maxStringSize = 4096;
+
+    explicit StringScanner(int minLength = 4, Encodings encodings = AllEncodings);
+
+    int getMinLength() const                { return minLength; }
+    Encodings getEncodings() const          { return encodings; }
+
+    /**
+     * @brief Append all strings of at least minLength characters starting in data[begin, end) to out
+     * The bytes around that range are context: strings starting before begin are skipped even
+     * if they continue into it, strings starting in it are read up to size. With maxStringSize
+     * bytes of context on both sides, consecutive ranges of larger data find every string once.
+     * @param vaddr address of the first byte of data, RVA_INVALID if data is not mapped
+     * @param end -1 for size
+     */
+    void scan(const uchar *data, int size, RVA vaddr, const QString &section,
+              StringTable *out, int begin = 0, int end = -1) const;
+
+private:
+    int minLength;
+    Encodings encodings;
+
+    int scanNarrow(const uchar *data, int size, RVA vaddr, const QString &section,
+                   StringTable *out) const;
+    int scanWide(const uchar *data, int size, bool bigEndian, RVA vaddr, const QString &section,
+                 StringTable *out) const;
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(StringScanner::Encodings)
+
+#endif // STRINGSCANNER_H
@@ -0,0 +1,153 @@
+#include "common/StringsTask.h"
+#include "common/CorePool.h"
+#include "common/Parallel.h"
+
+#include <QSharedPointer>
+
+#include <algorithm>
+
+static const int readChunkSize = 1024 * 1024;
+// Read around each chunk, so strings crossing its ends are found by the chunk they start in
+static const int chunkContext = StringScanner::maxStringSize;
+// Rows are appended to the model at most this often, each append re-sorts the view
+static const qint64 batchInterval = 250;
+
+StringsTask::StringsTask(const StringScanner &scanner, const QStringList &sections)
+    : scanner(scanner),
+      sections(sections)
+{
+    setProgressUnit(tr("bytes"));
+}
+
+QList<StringsTask::Region> StringsTask::getRegions()
+{
+    QList<Region> sections;
+    RVA fileSize;
+    // Bytes outside of sections only have an address if the file is mapped linearly there
+    auto gapRegion = [](RVA paddr, RVA size) {
+        RCoreLocked core = Core()->core();
+        RVA vaddr = paddr;
+        if (r_config_get_i(core->config, "io.va")) {
+            vaddr = r_io_p2v(core->io, paddr);
+            if (vaddr == UT64_MAX || r_io_p2v(core->io, paddr + size - 1) != vaddr + size - 1) {
+                vaddr = RVA_INVALID;
+            }
+        }
+        return Region { paddr, size, vaddr, QString() };
+    };
+    {
+        RCoreLocked core = Core()->core();
+        fileSize = r_io_size(core->io);
+        RList *binSections = core->bin ? r_bin_get_sections(core->bin) : nullptr;
+        RListIter *it;
+        RBinSection *section;
+        CutterRListForeach(binSections, it, RBinSection, section) {
+            // Segments cover the same bytes as the sections inside them
+            if (section->is_segment || !section->size) {
+                continue;
+            }
+            sections << Region { section->paddr, section->size, section->vaddr, QString(section->name) };
+        }
+    }
+    std::sort(sections.begin(), sections.end(), [](const Region &a, const Region &b) {
+        return a.paddr < b.paddr;
+    });
+
+    // Clip overlapping sections and fill the gaps, so every byte of the file is scanned once
+    QList<Region> ret;
+    RVA pos = 0;
+    for (Region region : sections) {
+        RVA end = qMin(region.paddr + region.size, fileSize);
+        if (end <= pos) {
+            continue;
+        }
+        if (region.paddr > pos) {
+            ret << gapRegion(pos, region.paddr - pos);
+        } else {
+            region.vaddr += pos - region.paddr;
+            region.paddr = pos;
+        }
+        region.size = end - region.paddr;
+        ret << region;
+        pos = end;
+    }
+    if (pos < fileSize) {
+        ret << gapRegion(pos, fileSize - pos);
+    }
+    if (!this->sections.isEmpty()) {
+        ret.erase(std::remove_if(ret.begin(), ret.end(), [this](const Region &region) {
+            return !this->sections.contains(region.section);
+        }), ret.end());
+    }
+    return ret;
+}
+
+void StringsTask::runTask()
+{
+    QList<Region> regions = getRegions();
+
+    qint64 total = 0;
+    for (const Region &region : regions) {
+        total += static_cast<qint64>(region.size);
+    }
+    qint64 done = 0;
+    setProgress(0, total);
+    batchTimer.start();
+
+    // Reads go through the CorePool without the core lock, so this thread reads the next chunks
+    // while the shared CPU pool scans the previous ones
+    Parallel::Pipeline pipeline;
+
+    for (const Region &region : regions) {
+        auto vaddrAt = [&region](RVA offset) {
+            return region.vaddr == RVA_INVALID ? RVA_INVALID : region.vaddr + offset;
+        };
+        RVA offset = 0;
+        while (offset < region.size) {
+            if (isInterrupted()) {
+                pipeline.cancel();
+                return;
+            }
+            RVA from = offset - qMin<RVA>(offset, chunkContext);
+            RVA len = qMin<RVA>(readChunkSize, region.size - offset);
+            RVA to = qMin(region.size, offset + len + chunkContext);
+            QByteArray data = Core()->getCorePool()->ioRead(region.paddr + from,
+                                                            static_cast<int>(to - from), true);
+            int begin = static_cast<int>(offset - from);
+            int end = qMin(begin + static_cast<int>(len), data.size());
+            if (end <= begin) {
+                break;
+            }
+            offset += static_cast<RVA>(end - begin);
+
+            QSharedPointer<StringTable> strings(new StringTable);
+            RVA vaddr = vaddrAt(from);
+            const QString &section = region.section;
+            pipeline.add([this, data, vaddr, section, begin, end, strings]() {
+                scanner.scan(reinterpret_cast<const uchar *>(data.constData()), data.size(), vaddr,
+                             section, strings.data(), begin, end);
+                // Its chunk is kept as it is by the tables it is appended to
+                strings->squeeze();
+            }, [this, strings]() {
+                batch.append(*strings);
+            });
+            setProgress(done + static_cast<qint64>(offset), total);
+            flushBatch(false);
+        }
+        done += static_cast<qint64>(region.size);
+        log(tr("Searched %1").arg(region.section.isEmpty()
+                                  ? RAddressString(region.paddr) : region.section));
+    }
+    pipeline.finish();
+    flushBatch(true);
+}
+
+void StringsTask::flushBatch(bool force)
+{
+    if (batch.isEmpty() || (!force && batchTimer.elapsed() < batchInterval)) {
+        return;
+    }
+    emit stringsFound(batch);
+    batch.clear();
+    batchTimer.restart();
+}
@@ -3,24 +3,57 @@
 #define STRINGSASYNCTASK_H
 
 #include "common/AsyncTask.h"
+#include "common/StringScanner.h"
 #include "core/Cutter.h"
 
+/**
+ * @brief Extracts strings region by region and delivers them in batches while scanning
+ *
+ * Each section of the binary and each gap between sections is read in chunks through r_io,
+ * so the first strings show up right away instead of after izzj has processed the whole file.
+ * Chunks overlap by StringScanner::maxStringSize bytes on both sides, each string is only kept
+ * by the chunk it starts in. They are scanned by a StringScanner on all cores while the next
+ * chunks are read. The task's finished() signal marks the end of the search.
+ */
 class StringsTask : public AsyncTask
 {
 Q_OBJECT
 
 public:
+    /**
+     * @param sections only search these sections, or the whole file if empty
+     */
+    explicit StringsTask(const StringScanner &scanner = StringScanner(),
+                         const QStringList &sections = QStringList());
+
     QString getTitle() override                     { return tr("Searching for Strings"); }
 
 signals:
-    void stringSearchFinished(const QList<StringDescription> &strings);
+    /**
+     * @brief A batch of strings found since the previous one, in ascending address order per region
+     */
+    void stringsFound(const StringTable &strings);
 
 protected:
-    void runTask() override
-    {
-        auto strings = Core()->getAllStrings();
-        emit stringSearchFinished(strings);
-    }
+    void runTask() override;
+
+private:
+    struct Region {
+        RVA paddr;
+        RVA size;
+        RVA vaddr;
+        QString section;
+    };
+
+    StringScanner scanner;
+    QStringList sections;
+
+    StringTable batch;
+    QElapsedTimer batchTimer;
+
+    QList<Region> getRegions();
+
+    void flushBatch(bool force);
 };
 
 #endif //STRINGSASYNCTASK_H
@@ -0,0 +1,229 @@
+#include "common/TrigramIndex.h"
+
+#include <algorithm>
+#include <iterator>
+
+TrigramIndex::TrigramIndex(const QStringList &texts)
+{
+    hashes.reserve(texts.size());
+    for (const QString &text : texts) {
+        append(text);
+    }
+}
+
+QVector<TrigramIndex::Trigram> TrigramIndex::trigrams(const QString &text)
+{
+    QVector<Trigram> ret;
+    if (text.size() < 3) {
+        return ret;
+    }
+    ret.reserve(text.size() - 2);
+    Trigram a = text[0].toCaseFolded().unicode();
+    Trigram b = text[1].toCaseFolded().unicode();
+    for (int i = 2; i < text.size(); i++) {
+        Trigram c = text[i].toCaseFolded().unicode();
+        ret.append((a << 32) | (b << 16) | c);
+        a = b;
+        b = c;
+    }
+    std::sort(ret.begin(), ret.end());
+    ret.erase(std::unique(ret.begin(), ret.end()), ret.end());
+    return ret;
+}
+
+void TrigramIndex::add(int id, const QString &text)
+{
+    for (Trigram trigram : trigrams(text)) {
+        QVector<int> &ids = postings[trigram];
+        if (ids.isEmpty() || ids.last() < id) {
+            ids.append(id);
+        } else {
+            ids.insert(std::lower_bound(ids.begin(), ids.end(), id), id);
+        }
+    }
+}
+
+void TrigramIndex::remove(int id)
+{
+    // The old text is unknown, but updates are rare (renames) compared to lookups
+    for (auto it = postings.begin(); it != postings.end();) {
+        QVector<int> &ids = it.value();
+        auto pos = std::lower_bound(ids.begin(), ids.end(), id);
+        if (pos != ids.end() && *pos == id) {
+            ids.erase(pos);
+        }
+        if (ids.isEmpty()) {
+            it = postings.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void TrigramIndex::append(const QString &text)
+{
+    add(hashes.size(), text);
+    hashes.append(qHash(text));
+}
+
+bool TrigramIndex::update(int id, const QString &text)
+{
+    uint hash = qHash(text);
+    if (id < 0 || id >= hashes.size() || hashes[id] == hash) {
+        return false;
+    }
+    remove(id);
+    add(id, text);
+    hashes[id] = hash;
+    return true;
+}
+
+void TrigramIndex::truncate(int size)
+{
+    size = qMax(size, 0);
+    if (size >= hashes.size()) {
+        return;
+    }
+    for (auto it = postings.begin(); it != postings.end();) {
+        QVector<int> &ids = it.value();
+        ids.erase(std::lower_bound(ids.begin(), ids.end(), size), ids.end());
+        if (ids.isEmpty()) {
+            it = postings.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    hashes.resize(size);
+}
+
+QStringList TrigramIndex::literalParts(const QRegExp &filter)
+{
+    QStringList ret;
+    const QString pattern = filter.pattern();
+    switch (filter.patternSyntax()) {
+    case QRegExp::FixedString:
+        ret << pattern;
+        return ret;
+    case QRegExp::Wildcard:
+    case QRegExp::WildcardUnix:
+        break;
+    default:
+        // Extracting required literals from regular expressions is not worth it here
+        return ret;
+    }
+
+    bool escapes = filter.patternSyntax() == QRegExp::WildcardUnix;
+    QString part;
+    for (int i = 0; i < pattern.size(); i++) {
+        QChar c = pattern[i];
+        if (escapes && c == QLatin1Char('\\') && i + 1 < pattern.size()) {
+            part += pattern[++i];
+        } else if (c == QLatin1Char('*') || c == QLatin1Char('?')) {
+            ret << part;
+            part.clear();
+        } else if (c == QLatin1Char('[')) {
+            ret << part;
+            part.clear();
+            int end = pattern.indexOf(QLatin1Char(']'), i + 2);
+            if (end < 0) {
+                // Not a valid class, nothing after it can be trusted
+                return ret;
+            }
+            i = end;
+        } else {
+            part += c;
+        }
+    }
+    ret << part;
+    return ret;
+}
+
+bool TrigramIndex::candidates(const QRegExp &filter, QVector<int> *result) const
+{
+    QVector<Trigram> required;
+    for (const QString &part : literalParts(filter)) {
+        required += trigrams(part);
+    }
+    if (required.isEmpty()) {
+        return false;
+    }
+
+    QVector<const QVector<int> *> lists;
+    for (Trigram trigram : required) {
+        auto it = postings.constFind(trigram);
+        if (it == postings.constEnd()) {
+            result->clear();
+            return true;
+        }
+        lists.append(&it.value());
+    }
+    // Intersect starting with the rarest trigram, which keeps the intermediate result small
+    std::sort(lists.begin(), lists.end(), [](const QVector<int> *a, const QVector<int> *b) {
+        return a->size() < b->size();
+    });
+    QVector<int> ids = *lists.first();
+    QVector<int> next;
+    for (int i = 1; i < lists.size() && !ids.isEmpty(); i++) {
+        next.clear();
+        std::set_intersection(ids.constBegin(), ids.constEnd(),
+                              lists[i]->constBegin(), lists[i]->constEnd(), std::back_inserter(next));
+        ids.swap(next);
+    }
+    *result = ids;
+    return true;
+}
+
+QVector<int> TrigramIndex::similar(const QString &query, int limit,
+                                   const std::function<int(int)> &textSize) const
+{
+    QHash<int, int> hits;
+    for (Trigram trigram : trigrams(query)) {
+        auto it = postings.constFind(trigram);
+        if (it == postings.constEnd()) {
+            continue;
+        }
+        for (int id : it.value()) {
+            hits[id]++;
+        }
+    }
+
+    QVector<QPair<int, int>> ranked;
+    ranked.reserve(hits.size());
+    for (auto it = hits.constBegin(); it != hits.constEnd(); ++it) {
+        ranked.append(qMakePair(it.value(), it.key()));
+    }
+    auto better = [&textSize](const QPair<int, int> &a, const QPair<int, int> &b) {
+        if (a.first != b.first) {
+            return a.first > b.first;
+        }
+        // Among equal hits, shorter texts are closer to the query
+        return textSize(a.second) < textSize(b.second);
+    };
+    int count = qMin(limit, ranked.size());
+    std::partial_sort(ranked.begin(), ranked.begin() + count, ranked.end(), better);
+
+    QVector<int> ret;
+    ret.reserve(count);
+    for (int i = 0; i < count; i++) {
+        ret.append(ranked[i].second);
+    }
+    return ret;
+}
+
+TrigramIndexTask::TrigramIndexTask(const QStringList &texts)
+    : texts(texts)
+{
+    setPriority(Priority::Background);
+}
+
+void TrigramIndexTask::runTask()
+{
+    TrigramIndex index;
+    for (int i = 0; i < texts.size(); i++) {
+        if ((i & 0xfff) == 0 && isInterrupted()) {
+            return;
+        }
+        index.append(texts[i]);
+    }
+    emit indexBuilt(index);
+}
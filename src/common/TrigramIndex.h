@@ -0,0 +1,97 @@
+#ifndef TRIGRAMINDEX_H
+#define TRIGRAMINDEX_H
+
+#include "common/AsyncTask.h"
+
+#include <QHash>
+#include <QRegExp>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <functional>
+
+/**
+ * @brief Inverted index from case folded character trigrams to the ids of the texts containing them
+ *
+ * Ids are the positions of the texts as they were added. The index only narrows down
+ * candidates, every candidate still has to be checked against the actual filter. The texts
+ * themselves are not kept, only a hash of each to notice changes, the owner of the index
+ * already has them.
+ * It is a value type with implicitly shared data, so it can be handed to worker threads
+ * and still be updated on the owning thread.
+ */
+class TrigramIndex
+{
+public:
+    TrigramIndex() = default;
+    explicit TrigramIndex(const QStringList &texts);
+
+    int size() const                        { return hashes.size(); }
+    bool isEmpty() const                    { return hashes.isEmpty(); }
+
+    void append(const QString &text);
+
+    /**
+     * @brief Replace the text of id
+     * @return false if text did not change
+     */
+    bool update(int id, const QString &text);
+
+    /**
+     * @brief Remove all ids >= size
+     */
+    void truncate(int size);
+
+    /**
+     * @brief Ids of all texts which may match filter, in ascending order
+     * @return false if filter can not be narrowed down (e.g. regular expressions or
+     *         no literal part of at least three characters), then all ids are candidates
+     */
+    bool candidates(const QRegExp &filter, QVector<int> *result) const;
+
+    /**
+     * @brief Ids of texts sharing the most trigrams with query, best first
+     * Useful for fuzzy matching where the query may contain typos.
+     * @param textSize returns the size of the text of an id, shorter texts win ties
+     */
+    QVector<int> similar(const QString &query, int limit,
+                         const std::function<int(int)> &textSize) const;
+
+private:
+    using Trigram = quint64;
+
+    QVector<uint> hashes;
+    QHash<Trigram, QVector<int>> postings;
+
+    static QVector<Trigram> trigrams(const QString &text);
+    static QStringList literalParts(const QRegExp &filter);
+    void add(int id, const QString &text);
+    void remove(int id);
+};
+
+/**
+ * @brief Builds a TrigramIndex in the background
+ */
+class TrigramIndexTask : public AsyncTask
+{
+    Q_OBJECT
+
+public:
+    explicit TrigramIndexTask(const QStringList &texts);
+
+    QString getTitle() override                     { return tr("Indexing names"); }
+
+signals:
+    void indexBuilt(const TrigramIndex &index);
+
+protected:
+    void runTask() override;
+
+private:
+    QStringList texts;
+};
+
+Q_DECLARE_METATYPE(TrigramIndex)
+
+#endif // TRIGRAMINDEX_H
@@ -7,6 +7,13 @@
 #include "common/TempConfig.h"
 #include "common/Configuration.h"
 #include "common/AsyncTask.h"
+#include "common/BlockStatisticsEngine.h"
+#include "common/EntropyMapProvider.h"
+#include "common/SectionEntropyProvider.h"
+#include "common/RefreshScheduler.h"
+#include "common/StallDetector.h"
+#include "common/Parallel.h"
+#include "common/CorePool.h"
 #include "common/R2Task.h"
 #include "common/Json.h"
 #include "core/Cutter.h"
@@ -15,6 +22,23 @@
 
 Q_GLOBAL_STATIC(CutterCore, uniqueInstance)
 
+/**
+ * @brief Makes the command running in the r2 console stop at its next check for a break
+ */
+static void breakConsole()
+{
+    r_cons_singleton()->context->breaked = true;
+}
+
+/**
+ * @brief Whether the calling thread runs a task which has been interrupted
+ */
+static bool currentTaskInterrupted()
+{
+    AsyncTask *task = AsyncTask::current();
+    return task && task->isInterrupted();
+}
+
 #define R_JSON_KEY(name) static const QString name = QStringLiteral(#name)
 
 namespace RJsonKey {
@@ -22,22 +46,18 @@ namespace RJsonKey {
     R_JSON_KEY(addr_end);
     R_JSON_KEY(baddr);
     R_JSON_KEY(bind);
-    R_JSON_KEY(blocks);
-    R_JSON_KEY(blocksize);
     R_JSON_KEY(bytes);
     R_JSON_KEY(calltype);
     R_JSON_KEY(cc);
     R_JSON_KEY(classname);
     R_JSON_KEY(code);
     R_JSON_KEY(comment);
-    R_JSON_KEY(comments);
     R_JSON_KEY(cost);
     R_JSON_KEY(data);
     R_JSON_KEY(description);
     R_JSON_KEY(ebbs);
     R_JSON_KEY(edges);
     R_JSON_KEY(enabled);
-    R_JSON_KEY(entropy);
     R_JSON_KEY(fcn_addr);
     R_JSON_KEY(fcn_name);
     R_JSON_KEY(fields);
@@ -46,11 +66,9 @@ namespace RJsonKey {
     R_JSON_KEY(flagname);
     R_JSON_KEY(format);
     R_JSON_KEY(from);
-    R_JSON_KEY(functions);
     R_JSON_KEY(graph);
     R_JSON_KEY(haddr);
     R_JSON_KEY(hw);
-    R_JSON_KEY(in_functions);
     R_JSON_KEY(index);
     R_JSON_KEY(jump);
     R_JSON_KEY(laddr);
@@ -77,15 +95,11 @@ namespace RJsonKey {
     R_JSON_KEY(ref);
     R_JSON_KEY(refs);
     R_JSON_KEY(reg);
-    R_JSON_KEY(rwx);
     R_JSON_KEY(section);
-    R_JSON_KEY(sections);
     R_JSON_KEY(size);
     R_JSON_KEY(stackframe);
     R_JSON_KEY(status);
     R_JSON_KEY(string);
-    R_JSON_KEY(strings);
-    R_JSON_KEY(symbols);
     R_JSON_KEY(text);
     R_JSON_KEY(to);
     R_JSON_KEY(trace);
@@ -183,6 +197,22 @@ void CutterCore::initialize()
 
     // Initialize Async tasks manager
     asyncTaskManager = new AsyncTaskManager(this);
+
+    // Connected first, so everything connected later already sees the new epoch
+    connect(this, &CutterCore::instructionChanged, this, [this]() {
+        patchEpoch++;
+    });
+
+    // Initialize navigation statistics, kept up to date with functions and flags
+    blockStatisticsEngine = new BlockStatisticsEngine(this);
+    entropyMapProvider = new EntropyMapProvider(this);
+    sectionEntropyProvider = new SectionEntropyProvider(this);
+
+    // Spreads the widget refreshes of refreshAll() over several frames
+    refreshScheduler = new RefreshScheduler(this);
+
+    // Lets tasks read the file without waiting for the core lock
+    corePool = new CorePool(this);
 }
 
 QList<QString> CutterCore::sdbList(QString path)
@@ -259,11 +289,21 @@ QString CutterCore::sanitizeStringForCommand(QString s)
  */
 QString CutterCore::cmd(const char *str)
 {
+    if (currentTaskInterrupted()) {
+        // Would be broken right away, nobody waits for the output anymore
+        return QString();
+    }
+    // Entered before locking, so waiting for a task holding the core is attributed as well
+    StallDetector::Scope stallScope(str);
     CORE_LOCK();
 
     RVA offset = core_->offset;
     r_core_task_sync_begin(core_);
-    char *res = r_core_cmd_str(this->core_, str);
+    char *res;
+    {
+        AsyncTask::BreakScope breakScope(breakConsole);
+        res = r_core_cmd_str(this->core_, str);
+    }
     r_core_task_sync_end(core_);
     QString o = QString(res ? res : "");
     r_mem_free(res);
@@ -282,33 +322,61 @@ QString CutterCore::cmdRaw(const QString &str)
 
 QJsonDocument CutterCore::cmdj(const char *str)
 {
+    if (currentTaskInterrupted()) {
+        return QJsonDocument();
+    }
+    StallDetector::Scope stallScope(str);
     CORE_LOCK();
 
     r_core_task_sync_begin(core_);
-    char *res = r_core_cmd_str(this->core_, str);
+    char *res;
+    {
+        AsyncTask::BreakScope breakScope(breakConsole);
+        res = r_core_cmd_str(this->core_, str);
+    }
     r_core_task_sync_end(core_);
-    QJsonDocument doc = parseJson(res, str);
+    QJsonDocument doc;
+    // A broken command leaves truncated JSON, which is not worth parsing or reporting
+    if (!currentTaskInterrupted()) {
+        doc = parseJson(res, str);
+    }
     r_mem_free(res);
 
     return doc;
 }
 
-QString CutterCore::cmdTask(const QString &str)
+QString CutterCore::cmdTask(const QString &str, int timeout)
 {
     R2Task task(str);
-    task.startTask();
-    task.joinTask();
+    runR2Task(task, str, timeout);
     return task.getResult();
 }
 
-QJsonDocument CutterCore::cmdjTask(const QString &str)
+QJsonDocument CutterCore::cmdjTask(const QString &str, int timeout)
 {
     R2Task task(str);
-    task.startTask();
-    task.joinTask();
+    if (!runR2Task(task, str, timeout)) {
+        return QJsonDocument();
+    }
     return parseJson(task.getResultRaw(), str);
 }
 
+bool CutterCore::runR2Task(R2Task &task, const QString &cmd, int timeout)
+{
+    if (currentTaskInterrupted()) {
+        return false;
+    }
+    AsyncTask::BreakScope breakScope([&task]() {
+        task.breakTask();
+    });
+    task.startTask();
+    if (!task.joinTask(timeout)) {
+        eprintf("Command \"%s\" broken after %d ms\n", cmd.toLocal8Bit().constData(), timeout);
+        return false;
+    }
+    return !currentTaskInterrupted();
+}
+
 QJsonDocument CutterCore::parseJson(const char *res, const char *cmd)
 {
     QByteArray json(res);
@@ -419,6 +487,8 @@ bool CutterCore::loadFile(QString path, ut64 baddr, ut64 mapaddr, int perms, int
     ut64 hashLimit = getConfigut64("cfg.hashlimit");
     r_bin_file_hash(core_->bin, hashLimit, path.toUtf8().constData(), NULL);
 
+    corePool->open(path);
+
     fflush(stdout);
     return true;
 }
@@ -467,6 +537,8 @@ void CutterCore::renameFunction(const QString &oldName, const QString &newName)
 void CutterCore::delFunction(RVA addr)
 {
     cmd("af- " + RAddressString(addr));
+    blockStatisticsEngine->updateFunctionAt(addr);
+    emit functionRemoved(addr);
     emit functionsChanged();
 }
 
@@ -479,12 +551,24 @@ void CutterCore::renameFlag(QString old_name, QString new_name)
 void CutterCore::delFlag(RVA addr)
 {
     cmd("f-@" + RAddressString(addr));
+    blockStatisticsEngine->updateFlagsAt(addr);
     emit flagsChanged();
 }
 
 void CutterCore::delFlag(const QString &name)
 {
+    RVA addr = RVA_INVALID;
+    {
+        CORE_LOCK();
+        RFlagItem *flag = r_flag_get(core_->flags, name.toUtf8().constData());
+        if (flag) {
+            addr = flag->offset;
+        }
+    }
     cmdRaw("f-" + name);
+    if (addr != RVA_INVALID) {
+        blockStatisticsEngine->updateFlagsAt(addr);
+    }
     emit flagsChanged();
 }
 
@@ -560,12 +644,16 @@ int CutterCore::sizeofDataMeta(RVA addr)
 void CutterCore::setComment(RVA addr, const QString &cmt)
 {
     cmd("CCu base64:" + cmt.toLocal8Bit().toBase64() + " @ " + QString::number(addr));
+    blockStatisticsEngine->updateCommentAt(addr);
+    emit commentChanged(addr);
     emit commentsChanged();
 }
 
 void CutterCore::delComment(RVA addr)
 {
     cmd("CC- @ " + QString::number(addr));
+    blockStatisticsEngine->updateCommentAt(addr);
+    emit commentChanged(addr);
     emit commentsChanged();
 }
 
@@ -633,6 +721,14 @@ void CutterCore::seekNext()
 
 void CutterCore::updateSeek()
 {
+    if (seekChangedPending.testAndSetOrdered(0, 1)) {
+        QMetaObject::invokeMethod(this, "emitSeekChanged", Qt::QueuedConnection);
+    }
+}
+
+void CutterCore::emitSeekChanged()
+{
+    seekChangedPending.storeRelease(0);
     emit seekChanged(core_->offset);
 }
 
@@ -827,6 +923,22 @@ RAnalFunction *CutterCore::functionAt(ut64 addr)
     return r_anal_get_fcn_in(core_->anal, addr, 0);
 }
 
+FunctionDescription CutterCore::getFunctionDescription(RVA addr, bool *ok)
+{
+    for (const FunctionDescription &function : parseFunctionsJson(cmdj("afij @ " + RAddressString(addr)))) {
+        if (function.offset == addr) {
+            if (ok) {
+                *ok = true;
+            }
+            return function;
+        }
+    }
+    if (ok) {
+        *ok = false;
+    }
+    return FunctionDescription();
+}
+
 QString CutterCore::cmdFunctionAt(QString addr)
 {
     QString ret;
@@ -855,6 +967,8 @@ QString CutterCore::createFunctionAt(RVA addr, QString name)
     name.remove(regExp);
     QString command = "af " + name + " " + RAddressString(addr);
     QString ret = cmd(command);
+    blockStatisticsEngine->updateFunctionAt(addr);
+    emit functionAdded(addr);
     emit functionsChanged();
     return ret;
 }
@@ -1014,7 +1128,7 @@ void CutterCore::startDebug()
         setConfig("asm.flags", false);
         currentlyDebugging = true;
         emit changeDebugView();
-        emit flagsChanged();
+        triggerFlagsChanged();
         emit refreshCodeViews();
     }
     emit stackChanged();
@@ -1036,7 +1150,7 @@ void CutterCore::startEmulation()
         currentlyDebugging = true;
         currentlyEmulating = true;
         emit changeDebugView();
-        emit flagsChanged();
+        triggerFlagsChanged();
     }
     emit stackChanged();
     emit refreshCodeViews();
@@ -1058,7 +1172,7 @@ void CutterCore::attachDebug(int pid)
         currentlyDebugging = true;
         currentlyOpenFile = getConfig("file.path");
         currentlyAttachedToPID = pid;
-        emit flagsChanged();
+        triggerFlagsChanged();
         emit changeDebugView();
     }
 }
@@ -1079,7 +1193,7 @@ void CutterCore::stopDebug()
         setConfig("asm.flags", true);
         setConfig("io.cache", false);
         currentlyDebugging = false;
-        emit flagsChanged();
+        triggerFlagsChanged();
         emit changeDefinedView();
     }
 }
@@ -1750,11 +1864,10 @@ QList<StringDescription> CutterCore::parseStringsJson(const QJsonDocument &doc)
 
 QList<FunctionDescription> CutterCore::parseFunctionsJson(const QJsonDocument &doc)
 {
-    QList<FunctionDescription> ret;
-    QJsonArray jsonArray = doc.array();
+    const QJsonArray jsonArray = doc.array();
 
-    for (const QJsonValue &value : jsonArray) {
-        QJsonObject jsonObject = value.toObject();
+    return Parallel::map<FunctionDescription>(jsonArray.size(), [&jsonArray](int i) {
+        QJsonObject jsonObject = jsonArray.at(i).toObject();
 
         FunctionDescription function;
 
@@ -1771,10 +1884,8 @@ QList<FunctionDescription> CutterCore::parseFunctionsJson(const QJsonDocument &d
         function.calls = jsonObject[RJsonKey::outdegree].toVariant().toULongLong();
         function.stackframe = jsonObject[RJsonKey::stackframe].toVariant().toULongLong();
 
-        ret << function;
-    }
-
-    return ret;
+        return function;
+    });
 }
 
 QList<FlagspaceDescription> CutterCore::getAllFlagspaces()
@@ -1797,17 +1908,20 @@ QList<FlagspaceDescription> CutterCore::getAllFlagspaces()
 
 QList<FlagDescription> CutterCore::getAllFlags(QString flagspace)
 {
-    CORE_LOCK();
-    QList<FlagDescription> ret;
+    QJsonArray flagsArray;
+    {
+        CORE_LOCK();
+        if (!flagspace.isEmpty())
+            cmd("fs " + flagspace);
+        else
+            cmd("fs *");
 
-    if (!flagspace.isEmpty())
-        cmd("fs " + flagspace);
-    else
-        cmd("fs *");
+        flagsArray = cmdj("fj").array();
+    }
 
-    QJsonArray flagsArray = cmdj("fj").array();
-    for (const QJsonValue &value : flagsArray) {
-        QJsonObject flagObject = value.toObject();
+    // Converting does not need r2, so other threads can use it meanwhile
+    return Parallel::map<FlagDescription>(flagsArray.size(), [&flagsArray](int i) {
+        QJsonObject flagObject = flagsArray.at(i).toObject();
 
         FlagDescription flag;
 
@@ -1815,9 +1929,8 @@ QList<FlagDescription> CutterCore::getAllFlags(QString flagspace)
         flag.size = flagObject[RJsonKey::size].toVariant().toULongLong();
         flag.name = flagObject[RJsonKey::name].toString();
 
-        ret << flag;
-    }
-    return ret;
+        return flag;
+    });
 }
 
 QList<SectionDescription> CutterCore::getAllSections()
@@ -1825,9 +1938,8 @@ QList<SectionDescription> CutterCore::getAllSections()
     CORE_LOCK();
     QList<SectionDescription> ret;
 
-    QJsonDocument sectionsDoc = cmdj("iSj entropy");
-    QJsonObject sectionsObj = sectionsDoc.object();
-    QJsonArray sectionsArray = sectionsObj[RJsonKey::sections].toArray();
+    // Hashing every section is slow, entropy is computed asynchronously by SectionEntropyProvider
+    QJsonArray sectionsArray = cmdj("iSj").array();
 
     for (const QJsonValue &value : sectionsArray) {
         QJsonObject sectionObject = value.toObject();
@@ -1843,7 +1955,7 @@ QList<SectionDescription> CutterCore::getAllSections()
         section.paddr = sectionObject[RJsonKey::paddr].toVariant().toULongLong();
         section.size = sectionObject[RJsonKey::size].toVariant().toULongLong();
         section.flags = sectionObject[RJsonKey::flags].toString();
-        section.entropy =  sectionObject[RJsonKey::entropy].toString();
+        section.entropy = sectionEntropyProvider->getEntropy(section.paddr, section.size);
 
         ret << section;
     }
@@ -2382,56 +2494,45 @@ QList<SearchDescription> CutterCore::getAllSearch(QString search_for, QString sp
     return ret;
 }
 
-BlockStatistics CutterCore::getBlockStatistics(unsigned int blocksCount)
+QList<SearchDescription> CutterCore::getAllSearch(QString search_for, QString space, RVA from, RVA to)
 {
-    if (blocksCount == 0) {
-        BlockStatistics ret;
-        ret.from = ret.to = ret.blocksize = 0;
-        return ret;
-    }
-    QJsonObject statsObj = cmdj("p-j " + QString::number(blocksCount)).object();
-
-    BlockStatistics ret;
-    ret.from = statsObj[RJsonKey::from].toVariant().toULongLong();
-    ret.to = statsObj[RJsonKey::to].toVariant().toULongLong();
-    ret.blocksize = statsObj[RJsonKey::blocksize].toVariant().toULongLong();
-
-    QJsonArray blocksArray = statsObj[RJsonKey::blocks].toArray();
-
-    for (const QJsonValue &value : blocksArray) {
-        QJsonObject blockObj = value.toObject();
-
-        BlockDescription block;
-
-        block.addr = blockObj[RJsonKey::offset].toVariant().toULongLong();
-        block.size = blockObj[RJsonKey::size].toVariant().toULongLong();
-        block.flags = blockObj[RJsonKey::flags].toInt(0);
-        block.functions = blockObj[RJsonKey::functions].toInt(0);
-        block.inFunctions = blockObj[RJsonKey::in_functions].toInt(0);
-        block.comments = blockObj[RJsonKey::comments].toInt(0);
-        block.symbols = blockObj[RJsonKey::symbols].toInt(0);
-        block.strings = blockObj[RJsonKey::strings].toInt(0);
-
-        block.rwx = 0;
-        QString rwxStr = blockObj[RJsonKey::rwx].toString();
-        if (rwxStr.length() == 3) {
-            if (rwxStr[0] == 'r') {
-                block.rwx |= (1 << 0);
-            }
-            if (rwxStr[1] == 'w') {
-                block.rwx |= (1 << 1);
-            }
-            if (rwxStr[2] == 'x') {
-                block.rwx |= (1 << 2);
-            }
-        }
+    CORE_LOCK();
+    // Set directly instead of through setConfig, this may run on a worker thread
+    QString oldIn = r_config_get(core_->config, "search.in");
+    ut64 oldFrom = r_config_get_i(core_->config, "search.from");
+    ut64 oldTo = r_config_get_i(core_->config, "search.to");
+    r_config_set(core_->config, "search.in", "range");
+    r_config_set_i(core_->config, "search.from", from);
+    r_config_set_i(core_->config, "search.to", to);
+
+    QList<SearchDescription> ret = getAllSearch(search_for, space);
+
+    r_config_set(core_->config, "search.in", oldIn.toUtf8().constData());
+    r_config_set_i(core_->config, "search.from", oldFrom);
+    r_config_set_i(core_->config, "search.to", oldTo);
+    return ret;
+}
 
-        ret.blocks << block;
+QList<QPair<RVA, RVA>> CutterCore::getSearchBoundaries()
+{
+    CORE_LOCK();
+    QList<QPair<RVA, RVA>> ret;
+    const char *mode = r_config_get(core_->config, "search.in");
+    RList *boundaries = r_core_get_boundaries_prot(core_, R_PERM_R, mode, "search");
+    RListIter *it;
+    RIOMap *map;
+    CutterRListForeach(boundaries, it, RIOMap, map) {
+        ret << qMakePair<RVA, RVA>(r_itv_begin(map->itv), r_itv_end(map->itv));
     }
-
+    r_list_free(boundaries);
     return ret;
 }
 
+BlockStatistics CutterCore::getBlockStatistics(unsigned int blocksCount)
+{
+    return blockStatisticsEngine->getStatistics(blocksCount);
+}
+
 QList<XrefDescription> CutterCore::getXRefs(RVA addr, bool to, bool whole_function,
                                             const QString &filterType)
 {
@@ -2489,6 +2590,7 @@ void CutterCore::addFlag(RVA offset, QString name, RVA size)
 {
     name = sanitizeStringForCommand(name);
     cmd(QString("f %1 %2 @ %3").arg(name).arg(size).arg(offset));
+    blockStatisticsEngine->updateFlagsAt(offset);
     emit flagsChanged();
 }
 
@@ -2532,6 +2634,8 @@ void CutterCore::handleREvent(int type, void *data)
 
 void CutterCore::triggerFlagsChanged()
 {
+    // Nobody told where
+    blockStatisticsEngine->invalidate();
     emit flagsChanged();
 }
 
@@ -2630,6 +2734,24 @@ QString CutterCore::hexdump(RVA address, int size, HexdumpFormats format)
                         .arg(address));
 }
 
+QByteArray CutterCore::ioRead(RVA addr, int len, bool physical)
+{
+    QByteArray buf;
+    if (len <= 0) {
+        return buf;
+    }
+    CORE_LOCK();
+    buf.resize(len);
+    auto *data = reinterpret_cast<ut8 *>(buf.data());
+    bool ok = physical
+              ? r_io_pread_at(core_->io, addr, data, len) > 0
+              : r_io_read_at(core_->io, addr, data, len);
+    if (!ok) {
+        buf.clear();
+    }
+    return buf;
+}
+
 QByteArray CutterCore::hexStringToBytes(const QString &hex)
 {
     QByteArray hexChars = hex.toUtf8();
@@ -5,6 +5,7 @@
 #include "core/CutterDescriptions.h"
 
 #include <QMap>
+#include <QAtomicInt>
 #include <QDebug>
 #include <QObject>
 #include <QStringList>
@@ -13,6 +14,12 @@
 #include <QErrorMessage>
 
 class AsyncTaskManager;
+class BlockStatisticsEngine;
+class EntropyMapProvider;
+class SectionEntropyProvider;
+class RefreshScheduler;
+class CorePool;
+class R2Task;
 class CutterCore;
 #include "plugins/CutterPlugin.h"
 #include "common/BasicBlockHighlighter.h"
@@ -46,9 +53,19 @@ public:
     void initialize();
 
     AsyncTaskManager *getAsyncTaskManager() { return asyncTaskManager; }
+    BlockStatisticsEngine *getBlockStatisticsEngine() { return blockStatisticsEngine; }
+    EntropyMapProvider *getEntropyMapProvider() { return entropyMapProvider; }
+    SectionEntropyProvider *getSectionEntropyProvider() { return sectionEntropyProvider; }
+    RefreshScheduler *getRefreshScheduler() { return refreshScheduler; }
+    CorePool *getCorePool() { return corePool; }
 
     RVA getOffset() const                   { return core_->offset; }
 
+    /**
+     * @brief Increases whenever bytes are changed through CutterCore, see instructionChanged()
+     */
+    int getPatchEpoch() const               { return patchEpoch; }
+
     /* Core functions (commands) */
     static QString sanitizeStringForCommand(QString s);
     QString cmd(const char *str);
@@ -58,8 +75,13 @@ public:
     QJsonDocument cmdj(const QString &str) { return cmdj(str.toUtf8().constData()); }
     QStringList cmdList(const char *str) { return cmd(str).split(QLatin1Char('\n'), QString::SkipEmptyParts); }
     QStringList cmdList(const QString &str) { return cmdList(str.toUtf8().constData()); }
-    QString cmdTask(const QString &str);
-    QJsonDocument cmdjTask(const QString &str);
+    /**
+     * @brief Run a command as an r2 task, which can be broken while it runs
+     * Interrupting the AsyncTask this is called from breaks the command.
+     * @param timeout milliseconds after which the command is broken, -1 to wait until it is done
+     */
+    QString cmdTask(const QString &str, int timeout = -1);
+    QJsonDocument cmdjTask(const QString &str, int timeout = -1);
     void cmdEsil(const char *command);
     void cmdEsil(const QString &command) { cmdEsil(command.toUtf8().constData()); }
     QString getVersionInformation();
@@ -77,6 +99,11 @@ public:
     void delFunction(RVA addr);
     void renameFlag(QString old_name, QString new_name);
     RAnalFunction *functionAt(ut64 addr);
+    /**
+     * @brief Describe the function starting exactly at addr
+     * @param ok set to false if there is no such function
+     */
+    FunctionDescription getFunctionDescription(RVA addr, bool *ok = nullptr);
     QString cmdFunctionAt(QString addr);
     QString cmdFunctionAt(RVA addr);
     QString createFunctionAt(RVA addr, QString name);
@@ -199,6 +226,13 @@ public:
     QString hexdump(RVA offset, int size, HexdumpFormats format);
     QString getHexdumpPreview(RVA offset, int size);
 
+    /**
+     * @brief Read raw bytes through r_io without going through a command
+     * @param physical if true, addr is a file offset, otherwise a virtual address
+     * @return the bytes read, empty on failure
+     */
+    QByteArray ioRead(RVA addr, int len, bool physical = false);
+
     void setCPU(QString arch, QString cpu, int bits);
     void setEndianness(bool big);
 
@@ -351,6 +385,14 @@ public:
 
     QList<MemoryMapDescription> getMemoryMap();
     QList<SearchDescription> getAllSearch(QString search_for, QString space);
+    /**
+     * @brief Run the search only over [from, to), independently of search.in
+     */
+    QList<SearchDescription> getAllSearch(QString search_for, QString space, RVA from, RVA to);
+    /**
+     * @brief The address ranges the current search.in setting stands for
+     */
+    QList<QPair<RVA, RVA>> getSearchBoundaries();
     BlockStatistics getBlockStatistics(unsigned int blocksCount);
     QList<BreakpointDescription> getBreakpoints();
     QList<ProcessDescription> getAllProcesses();
@@ -387,8 +429,20 @@ signals:
 
     void functionRenamed(const QString &prev_name, const QString &new_name);
     void varsChanged();
+    /**
+     * @brief Emitted right before functionsChanged() when a single function was created
+     */
+    void functionAdded(RVA addr);
+    /**
+     * @brief Emitted right before functionsChanged() when a single function was deleted
+     */
+    void functionRemoved(RVA addr);
     void functionsChanged();
     void flagsChanged();
+    /**
+     * @brief Emitted right before commentsChanged() when only the comment at addr was set or deleted
+     */
+    void commentChanged(RVA addr);
     void commentsChanged();
     void registersChanged();
     void instructionChanged(RVA offset);
@@ -415,6 +469,8 @@ signals:
 
     /**
      * @brief seekChanged is emitted each time radare2 seek value is modified
+     * Seeks are coalesced, so when seeking several times before the event loop runs again,
+     * e.g. while dragging on the navigation bar, it is only emitted once with the final offset.
      * @param offset
      */
     void seekChanged(RVA offset);
@@ -432,11 +488,31 @@ private:
     QString notes;
     RCore *core_ = nullptr;
     AsyncTaskManager *asyncTaskManager;
+    BlockStatisticsEngine *blockStatisticsEngine;
+    EntropyMapProvider *entropyMapProvider;
+    SectionEntropyProvider *sectionEntropyProvider;
+    RefreshScheduler *refreshScheduler;
+    CorePool *corePool;
+    int patchEpoch = 0;
     RVA offsetPriorDebugging = RVA_INVALID;
     QErrorMessage msgBox;
 
     bool emptyGraph = false;
     BasicBlockHighlighter *bbHighlighter;
+
+    /**
+     * Set while an emitSeekChanged() is queued, updateSeek() may be called from any thread
+     */
+    QAtomicInt seekChangedPending;
+
+    /**
+     * @brief Start task and wait for it, breaking it if the calling AsyncTask is interrupted
+     * @return false if it was not run completely
+     */
+    bool runR2Task(R2Task &task, const QString &cmd, int timeout);
+
+private slots:
+    void emitSeekChanged();
 };
 
 #endif // CUTTER_H
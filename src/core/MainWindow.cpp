@@ -10,6 +10,7 @@
 #include "common/ProgressIndicator.h"
 #include "common/TempConfig.h"
 #include "common/RunScriptTask.h"
+#include "common/ExportCodeTask.h"
 #include "common/PythonManager.h"
 #include "plugins/PluginManager.h"
 #include "CutterConfig.h"
@@ -545,11 +546,6 @@ bool MainWindow::saveProjectAs(bool quit)
     return SaveProjectDialog::Rejected != dialog.exec();
 }
 
-void MainWindow::refreshOmniBar(const QStringList &flags)
-{
-    omnibar->refresh(flags);
-}
-
 void MainWindow::setFilename(const QString &fn)
 {
     // Add file name to window title
@@ -1081,33 +1077,39 @@ void MainWindow::on_actionImportPDB_triggered()
 
 void MainWindow::on_actionExport_as_code_triggered()
 {
+    exportAsCode(0, Core()->num("$s"), true);
+}
+
+void MainWindow::exportAsCode(RVA offset, RVA size, bool physical)
+{
+    using Format = ExportCodeTask::Format;
     QStringList filters;
-    QMap<QString, QString> cmdMap;
+    QMap<QString, Format> formatMap;
 
     filters << tr("C uin8_t array (*.c)");
-    cmdMap[filters.last()] = "pc";
+    formatMap[filters.last()] = Format::CArray8;
     filters << tr("C uin16_t array (*.c)");
-    cmdMap[filters.last()] = "pch";
+    formatMap[filters.last()] = Format::CArray16;
     filters << tr("C uin32_t array (*.c)");
-    cmdMap[filters.last()] = "pcw";
+    formatMap[filters.last()] = Format::CArray32;
     filters << tr("C uin64_t array (*.c)");
-    cmdMap[filters.last()] = "pcd";
+    formatMap[filters.last()] = Format::CArray64;
     filters << tr("C string (*.c)");
-    cmdMap[filters.last()] = "pcs";
+    formatMap[filters.last()] = Format::CString;
     filters << tr("Shell-script that reconstructs the bin (*.sh)");
-    cmdMap[filters.last()] = "pcS";
+    formatMap[filters.last()] = Format::Shell;
     filters << tr("JSON array (*.json)");
-    cmdMap[filters.last()] = "pcj";
+    formatMap[filters.last()] = Format::Json;
     filters << tr("JavaScript array (*.js)");
-    cmdMap[filters.last()] = "pcJ";
+    formatMap[filters.last()] = Format::JavaScript;
     filters << tr("Python array (*.py)");
-    cmdMap[filters.last()] = "pcp";
+    formatMap[filters.last()] = Format::Python;
     filters << tr("Print 'wx' r2 commands (*.r2)");
-    cmdMap[filters.last()] = "pc*";
+    formatMap[filters.last()] = Format::R2Commands;
     filters << tr("GAS .byte blob (*.asm, *.s)");
-    cmdMap[filters.last()] = "pca";
+    formatMap[filters.last()] = Format::Gas;
     filters << tr(".bytes with instructions in comments (*.txt)");
-    cmdMap[filters.last()] = "pcA";
+    formatMap[filters.last()] = Format::GasWithInstructions;
 
     QFileDialog dialog(this, tr("Export as code"));
     dialog.setAcceptMode(QFileDialog::AcceptSave);
@@ -1118,16 +1120,26 @@ void MainWindow::on_actionExport_as_code_triggered()
     if (!dialog.exec())
         return;
 
-    QFile file(dialog.selectedFiles()[0]);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        qWarning() << "Can't open file";
-        return;
-    }
-    TempConfig tempConfig;
-    tempConfig.set("io.va", false);
-    QTextStream fileOut(&file);
-    QString &cmd = cmdMap[dialog.selectedNameFilter()];
-    fileOut << Core()->cmd(cmd + " $s @ 0");
+    auto *exportTask = new ExportCodeTask(dialog.selectedFiles()[0],
+                                          formatMap[dialog.selectedNameFilter()],
+                                          offset, size, physical);
+    AsyncTask::Ptr exportTaskPtr(exportTask);
+
+    connect(exportTask, &ExportCodeTask::exportFinished, this,
+    [this](bool success, const QString & fileName) {
+        if (success) {
+            core->message(tr("Exported to %1").arg(fileName));
+        } else {
+            core->message(tr("Failed to export to %1").arg(fileName));
+        }
+    });
+
+    AsyncTaskDialog *taskDialog = new AsyncTaskDialog(exportTaskPtr, this);
+    taskDialog->setInterruptOnClose(true);
+    taskDialog->setAttribute(Qt::WA_DeleteOnClose);
+    taskDialog->show();
+
+    Core()->getAsyncTaskManager()->start(exportTaskPtr);
 }
 
 
@@ -92,7 +92,6 @@ public:
     void readDebugSettings();
     void saveDebugSettings();
     void setFilename(const QString &fn);
-    void refreshOmniBar(const QStringList &flags);
 
     void addToDockWidgetList(QDockWidget *dockWidget);
     void addDockWidgetAction(QDockWidget *dockWidget, QAction *action);
@@ -111,6 +110,12 @@ public:
     }
     void messageBoxWarning(QString title, QString message);
 
+    /**
+     * @brief Ask for a file and format, then export size bytes at offset as code in the background
+     * @param physical whether offset is a file offset instead of a virtual address
+     */
+    void exportAsCode(RVA offset, RVA size, bool physical);
+
 public slots:
     void finalizeOpen();
 
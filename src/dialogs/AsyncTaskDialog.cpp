@@ -22,7 +22,11 @@ AsyncTaskDialog::AsyncTaskDialog(AsyncTask::Ptr task, QWidget *parent)
         close();
     });
 
+    connect(task.data(), &AsyncTask::progressChanged, this, &AsyncTaskDialog::updateProgress);
+    connect(task.data(), &AsyncTask::phaseChanged, this, &AsyncTaskDialog::updatePhases);
+
     updateLog(task->getLog());
+    updateProgress(task->getProgressDone(), task->getProgressTotal());
 
     connect(&timer, SIGNAL(timeout()), this, SLOT(updateProgressTimer()));
     timer.setInterval(1000);
@@ -41,23 +45,94 @@ void AsyncTaskDialog::updateLog(const QString &log)
     ui->logTextEdit->setPlainText(log);
 }
 
+void AsyncTaskDialog::updateProgress(qint64 done, qint64 total)
+{
+    updateProgressLabel();
+    if (total <= 0) {
+        // Unknown amount of work, show a busy indicator
+        ui->progressBar->setMaximum(0);
+        return;
+    }
+    // QProgressBar only takes ints, so scale to per mille
+    ui->progressBar->setMaximum(1000);
+    ui->progressBar->setValue(static_cast<int>(qBound<qint64>(0, done * 1000 / total, 1000)));
+}
+
 void AsyncTaskDialog::updateProgressTimer()
 {
-    int secondsElapsed = (task->getElapsedTime() + 500) / 1000;
-    int minutesElapsed = secondsElapsed / 60;
-    int hoursElapsed = minutesElapsed / 60;
+    ui->timeLabel->setText(tr("Running for") + " " + durationString(task->getElapsedTime()));
+    // Signals only come while progress is made, the rate and remaining time change anyway
+    updateProgressLabel();
+    updatePhases();
+}
+
+void AsyncTaskDialog::updateProgressLabel()
+{
+    QStringList parts;
+    QString phase = task->getPhase();
+    if (!phase.isEmpty()) {
+        parts << phase;
+    }
+    double rate = task->getRate();
+    if (rate > 0.0) {
+        parts << rateString(rate);
+    }
+    qint64 remaining = task->getRemainingTime();
+    if (remaining >= 0) {
+        parts << tr("about %1 left").arg(durationString(remaining));
+    }
+    ui->progressLabel->setText(parts.join(QStringLiteral(", ")));
+    ui->progressLabel->setVisible(!parts.isEmpty());
+}
 
-    QString label = tr("Running for") + " ";
-    if (hoursElapsed) {
-        label += tr("%n hour", "%n hours", hoursElapsed);
+void AsyncTaskDialog::updatePhases()
+{
+    const QList<AsyncTask::Phase> phases = task->getPhases();
+    // A single phase says nothing the progress label does not
+    ui->phasesTreeWidget->setVisible(phases.size() > 1);
+    while (ui->phasesTreeWidget->topLevelItemCount() > phases.size()) {
+        delete ui->phasesTreeWidget->takeTopLevelItem(ui->phasesTreeWidget->topLevelItemCount() - 1);
+    }
+    for (int i = 0; i < phases.size(); i++) {
+        const AsyncTask::Phase &phase = phases[i];
+        QTreeWidgetItem *item = ui->phasesTreeWidget->topLevelItem(i);
+        if (!item) {
+            item = new QTreeWidgetItem(ui->phasesTreeWidget);
+        }
+        item->setText(0, phase.name);
+        item->setText(1, durationString(phase.elapsed));
+        item->setText(2, phase.elapsed > 0 && phase.done > 0
+                      ? rateString(phase.done * 1000.0 / phase.elapsed) : QString());
+    }
+    updateProgressLabel();
+}
+
+QString AsyncTaskDialog::durationString(qint64 ms)
+{
+    int seconds = static_cast<int>((ms + 500) / 1000);
+    int minutes = seconds / 60;
+    int hours = minutes / 60;
+
+    QString label;
+    if (hours) {
+        label += tr("%n hour", "%n hours", hours);
         label += " ";
     }
-    if (minutesElapsed) {
-        label += tr("%n minute", "%n minutes", minutesElapsed % 60);
+    if (minutes) {
+        label += tr("%n minute", "%n minutes", minutes % 60);
         label += " ";
     }
-    label += tr("%n seconds", "%n second", secondsElapsed % 60);
-    ui->timeLabel->setText(label);
+    label += tr("%n seconds", "%n second", seconds % 60);
+    return label;
+}
+
+QString AsyncTaskDialog::rateString(double rate)
+{
+    QString unit = task->getProgressUnit();
+    if (unit.isEmpty()) {
+        unit = tr("items");
+    }
+    return tr("%L1 %2/s").arg(rate, 0, 'f', rate < 10.0 ? 1 : 0).arg(unit);
 }
 
 void AsyncTaskDialog::closeEvent(QCloseEvent *event)
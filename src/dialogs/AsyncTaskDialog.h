@@ -29,7 +29,9 @@ public slots:
 
 private slots:
     void updateLog(const QString &log);
+    void updateProgress(qint64 done, qint64 total);
     void updateProgressTimer();
+    void updatePhases();
 
 protected:
     void closeEvent(QCloseEvent *event) override;
@@ -40,6 +42,10 @@ private:
     QTimer timer;
 
     bool interruptOnClose = false;
+
+    QString durationString(qint64 ms);
+    QString rateString(double rate);
+    void updateProgressLabel();
 };
 
 #endif //ASYNCTASKDIALOG_H
@@ -29,6 +29,9 @@ void GraphOptionsWidget::updateOptionsFromVars()
     ui->maxColsSpinBox->blockSignals(true);
     ui->maxColsSpinBox->setValue(Config()->getGraphBlockMaxChars());
     ui->maxColsSpinBox->blockSignals(false);
+    ui->loadDelaySpinBox->blockSignals(true);
+    ui->loadDelaySpinBox->setValue(Config()->getGraphLoadDelay());
+    ui->loadDelaySpinBox->blockSignals(false);
 }
 
 
@@ -45,6 +48,12 @@ void GraphOptionsWidget::on_maxColsSpinBox_valueChanged(int value)
     triggerOptionsChanged();
 }
 
+void GraphOptionsWidget::on_loadDelaySpinBox_valueChanged(int value)
+{
+    // Only read when seeking, the graph does not have to be refreshed
+    Config()->setGraphLoadDelay(value);
+}
+
 void GraphOptionsWidget::on_graphOffsetCheckBox_toggled(bool checked)
 {
     Config()->setConfig("graph.offset", checked);
@@ -31,6 +31,7 @@ private slots:
     void updateOptionsFromVars();
 
     void on_maxColsSpinBox_valueChanged(int value);
+    void on_loadDelaySpinBox_valueChanged(int value);
     void on_graphOffsetCheckBox_toggled(bool checked);
 };
 
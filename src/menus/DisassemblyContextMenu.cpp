@@ -9,6 +9,7 @@
 #include "dialogs/SetToDataDialog.h"
 #include "dialogs/EditFunctionDialog.h"
 #include "dialogs/LinkTypeDialog.h"
+#include "common/BlockStatisticsEngine.h"
 
 #include <QtCore>
 #include <QShortcut>
@@ -826,12 +827,16 @@ void DisassemblyContextMenu::on_actionEditFunction_triggered()
             QString new_name = dialog.getNameText();
             Core()->renameFunction(fcn->name, new_name);
             QString new_start_addr = dialog.getStartAddrText();
+            RVA oldAddr = fcn->addr;
             fcn->addr = Core()->math(new_start_addr);
             QString new_end_addr = dialog.getEndAddrText();
             Core()->cmd("afu " + new_end_addr);
             QString new_stack_size = dialog.getStackSizeText();
             fcn->stack = int(Core()->math(new_stack_size));
             Core()->cmd("afc " + dialog.getCallConSelected());
+            // The function may have been moved and resized
+            Core()->getBlockStatisticsEngine()->updateFunctionAt(oldAddr);
+            Core()->getBlockStatisticsEngine()->updateFunctionAt(fcn->addr);
             emit Core()->functionsChanged();
         }
     }
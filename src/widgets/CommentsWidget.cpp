@@ -2,6 +2,7 @@
 #include "ui_CommentsWidget.h"
 #include "core/MainWindow.h"
 #include "common/Helpers.h"
+#include "common/RefreshScheduler.h"
 
 #include <QMenu>
 #include <QResizeEvent>
@@ -325,20 +326,26 @@ void CommentsWidget::resizeEvent(QResizeEvent *event)
 
 void CommentsWidget::refreshTree()
 {
-    commentsModel->beginResetModel();
-
-    comments = Core()->getAllComments("CCu");
-    nestedComments.clear();
-    for (const CommentDescription &comment : comments) {
-        QString fcnName = Core()->cmdFunctionAt(comment.offset);
-        nestedComments[fcnName].append(comment);
-    }
-
-    commentsModel->endResetModel();
+    using Comments = QPair<QList<CommentDescription>, QMap<QString, QList<CommentDescription>>>;
+    // Looking up the function of every comment is the slow part, so it is fetched as well
+    Core()->getRefreshScheduler()->schedule<Comments>(this, []() {
+        Comments result;
+        result.first = Core()->getAllComments("CCu");
+        for (const CommentDescription &comment : result.first) {
+            QString fcnName = Core()->cmdFunctionAt(comment.offset);
+            result.second[fcnName].append(comment);
+        }
+        return result;
+    }, [this](const Comments &result) {
+        commentsModel->beginResetModel();
+        comments = result.first;
+        nestedComments = result.second;
+        commentsModel->endResetModel();
 
-    qhelpers::adjustColumns(ui->commentsTreeView, 3, 0);
+        qhelpers::adjustColumns(ui->commentsTreeView, 3, 0);
 
-    tree->showItemsNumber(commentsProxyModel->rowCount());
+        tree->showItemsNumber(commentsProxyModel->rowCount());
+    });
 }
 
 void CommentsWidget::setScrollMode()
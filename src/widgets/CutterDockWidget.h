@@ -55,6 +55,22 @@ public:
         return deferrer;
     }
 
+    /**
+     * @brief Convenience method for creating and registering a RefreshDeferrer with a RangeUnionRefreshDeferrerAccumulator
+     * @param refreshNowFunc lambda taking a const RefreshRanges &, the union of all changes passed to
+     * RefreshDeferrer::attemptRefreshWith() while refreshing was deferred
+     */
+    template<typename Func>
+    RefreshDeferrer *createRangeRefreshDeferrer(Func refreshNowFunc)
+    {
+        auto *deferrer = new RefreshDeferrer(new RangeUnionRefreshDeferrerAccumulator(), this);
+        deferrer->registerFor(this);
+        connect(deferrer, &RefreshDeferrer::refreshNow, this, [refreshNowFunc](const RefreshDeferrerParamsResult paramsResult) {
+            refreshNowFunc(*static_cast<const RefreshRanges *>(paramsResult));
+        });
+        return deferrer;
+    }
+
 signals:
     void becameVisibleToUser();
 
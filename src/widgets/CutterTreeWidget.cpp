@@ -23,4 +23,11 @@ void CutterTreeWidget::showItemsNumber(int count)
     }
 }
 
+void CutterTreeWidget::showItemsNumber(int count, int percentDone)
+{
+    if(bar){
+        bar->showMessage(tr("%1 Items (searching, %2% done)").arg(count).arg(percentDone));
+    }
+}
+
 CutterTreeWidget::~CutterTreeWidget() {}
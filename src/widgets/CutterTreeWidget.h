@@ -16,6 +16,7 @@ public:
     ~CutterTreeWidget();
     void addStatusBar(QVBoxLayout *pos);
     void showItemsNumber(int count);
+    void showItemsNumber(int count, int percentDone);
 
 private:
     QStatusBar *bar;
@@ -54,6 +54,11 @@ DisassemblerGraphView::DisassemblerGraphView(QWidget *parent)
     connect(Config(), SIGNAL(fontsUpdated()), this, SLOT(fontsUpdatedSlot()));
     connectSeekChanged(false);
 
+    // Holding a navigation key or dragging on the navigation bar seeks through many functions,
+    // only the one where seeking settles is loaded
+    seekGraphTimer.setSingleShot(true);
+    connect(&seekGraphTimer, &QTimer::timeout, this, &DisassemblerGraphView::showSeekedGraph);
+
     // Space to switch to disassembly
     QShortcut *shortcut_disassembly = new QShortcut(QKeySequence(Qt::Key_Space), this);
     shortcut_disassembly->setContext(Qt::WidgetShortcut);
@@ -694,23 +699,36 @@ void DisassemblerGraphView::onSeekChanged(RVA addr)
     DisassemblyBlock *db = blockForAddress(addr);
     if (db) {
         // This is a local address! We animated to it.
+        seekGraphTimer.stop();
         transition_dont_seek = true;
         showBlock(&blocks[db->entry]);
         prepareHeader();
     } else {
-        refreshView();
-        db = blockForAddress(addr);
-        if (db) {
-            // This is a local address! We animated to it.
-            transition_dont_seek = true;
-            showBlock(&blocks[db->entry]);
-            prepareHeader();
+        seekGraphAddr = addr;
+        int delay = Config()->getGraphLoadDelay();
+        if (delay > 0) {
+            seekGraphTimer.start(delay);
         } else {
-            header->hide();
+            showSeekedGraph();
         }
     }
 }
 
+void DisassemblerGraphView::showSeekedGraph()
+{
+    seekGraphTimer.stop();
+    refreshView();
+    DisassemblyBlock *db = blockForAddress(seekGraphAddr);
+    if (db) {
+        // This is a local address! We animated to it.
+        transition_dont_seek = true;
+        showBlock(&blocks[db->entry]);
+        prepareHeader();
+    } else {
+        header->hide();
+    }
+}
+
 void DisassemblerGraphView::zoom(QPointF mouseRelativePos, double velocity)
 {
     mouseRelativePos.rx() *= size().width();
@@ -7,6 +7,7 @@
 #include <QPainter>
 #include <QShortcut>
 #include <QLabel>
+#include <QTimer>
 
 #include "widgets/GraphView.h"
 #include "menus/DisassemblyContextMenu.h"
@@ -135,10 +136,17 @@ protected:
 
 private slots:
     void on_actionExportGraph_triggered();
+    void showSeekedGraph();
 
 private:
     bool transition_dont_seek = false;
 
+    /**
+     * Delays loading the graph of another function after seeking, see Configuration::getGraphLoadDelay()
+     */
+    QTimer seekGraphTimer;
+    RVA seekGraphAddr = RVA_INVALID;
+
     Token *highlight_token;
     // Font data
     CachedFontMetrics *mFontMetrics;
@@ -75,6 +75,9 @@ DisassemblyWidget::DisassemblyWidget(MainWindow *main, QAction *action)
     disasmRefresh = createReplacingRefreshDeferrer<RVA>(false, [this](const RVA *offset) {
         refreshDisasm(offset ? *offset : RVA_INVALID);
     });
+    changesRefresh = createRangeRefreshDeferrer([this](const RefreshRanges &changes) {
+        refreshChanges(changes);
+    });
 
     maxLines = 0;
     updateMaxLines();
@@ -118,17 +121,22 @@ DisassemblyWidget::DisassemblyWidget(MainWindow *main, QAction *action)
         }
     });
 
-    connect(Core(), SIGNAL(commentsChanged()), this, SLOT(refreshDisasm()));
-    connect(Core(), SIGNAL(flagsChanged()), this, SLOT(refreshDisasm()));
+    // Comments and bytes only show at their own address, so they only need a refresh if it is shown.
+    // Every comment change comes with commentChanged(), commentsChanged() is left to the others.
+    connect(Core(), &CutterCore::commentChanged, this, [this](RVA addr) {
+        refreshChanges(RefreshRanges(RefreshRanges::Comments, addr));
+    });
+    // Flags are also shown by every line referencing them
+    connect(Core(), &CutterCore::flagsChanged, this, [this]() {
+        refreshChanges(RefreshRanges::everywhere(RefreshRanges::Flags));
+    });
     connect(Core(), SIGNAL(functionsChanged()), this, SLOT(refreshDisasm()));
     connect(Core(), SIGNAL(functionRenamed(const QString &, const QString &)), this,
             SLOT(refreshDisasm()));
     connect(Core(), SIGNAL(varsChanged()), this, SLOT(refreshDisasm()));
     connect(Core(), SIGNAL(asmOptionsChanged()), this, SLOT(refreshDisasm()));
     connect(Core(), &CutterCore::instructionChanged, this, [this](RVA offset) {
-        if (offset >= topOffset && offset <= bottomOffset) {
-            refreshDisasm();
-        }
+        refreshChanges(RefreshRanges(RefreshRanges::Bytes, offset));
     });
     connect(Core(), SIGNAL(refreshCodeViews()), this, SLOT(refreshDisasm()));
 
@@ -204,6 +212,20 @@ QWidget *DisassemblyWidget::getTextWidget()
     return mDisasTextEdit;
 }
 
+void DisassemblyWidget::refreshChanges(const RefreshRanges &changes)
+{
+    if (!changesRefresh->attemptRefreshWith(changes)) {
+        return;
+    }
+    if (topOffset == RVA_INVALID) {
+        return;
+    }
+    RVA end = bottomOffset == RVA_MAX ? RVA_MAX : bottomOffset + 1;
+    if (changes.intersects(topOffset, end)) {
+        refreshDisasm();
+    }
+}
+
 void DisassemblyWidget::refreshDisasm(RVA offset)
 {
     if(!disasmRefresh->attemptRefresh(offset == RVA_INVALID ? nullptr : new RVA(offset))) {
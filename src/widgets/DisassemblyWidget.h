@@ -62,6 +62,12 @@ private:
     bool seekFromCursor;
 
     RefreshDeferrer *disasmRefresh;
+    /**
+     * Collects changes while hidden, so showing the widget only refreshes it if they are on screen
+     */
+    RefreshDeferrer *changesRefresh;
+
+    void refreshChanges(const RefreshRanges &changes);
 
     RVA readCurrentDisassemblyOffset();
     RVA readDisassemblyOffset(QTextCursor tc);
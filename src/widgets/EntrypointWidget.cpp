@@ -3,6 +3,7 @@
 
 #include "core/MainWindow.h"
 #include "common/Helpers.h"
+#include "common/RefreshScheduler.h"
 
 #include <QTreeWidget>
 #include <QPen>
@@ -27,16 +28,20 @@ EntrypointWidget::~EntrypointWidget() {}
 
 void EntrypointWidget::fillEntrypoint()
 {
-    ui->entrypointTreeWidget->clear();
-    for (const EntrypointDescription &i : Core()->getAllEntrypoint()) {
-        QTreeWidgetItem *item = new QTreeWidgetItem();
-        item->setText(0, RAddressString(i.vaddr));
-        item->setText(1, i.type);
-        item->setData(0, Qt::UserRole, QVariant::fromValue(i));
-        ui->entrypointTreeWidget->addTopLevelItem(item);
-    }
-
-    qhelpers::adjustColumns(ui->entrypointTreeWidget, 0, 10);
+    Core()->getRefreshScheduler()->schedule<QList<EntrypointDescription>>(this, []() {
+        return Core()->getAllEntrypoint();
+    }, [this](const QList<EntrypointDescription> &entrypoints) {
+        ui->entrypointTreeWidget->clear();
+        for (const EntrypointDescription &i : entrypoints) {
+            QTreeWidgetItem *item = new QTreeWidgetItem();
+            item->setText(0, RAddressString(i.vaddr));
+            item->setText(1, i.type);
+            item->setData(0, Qt::UserRole, QVariant::fromValue(i));
+            ui->entrypointTreeWidget->addTopLevelItem(item);
+        }
+
+        qhelpers::adjustColumns(ui->entrypointTreeWidget, 0, 10);
+    });
 }
 
 void EntrypointWidget::setScrollMode()
@@ -3,6 +3,7 @@
 #include "core/MainWindow.h"
 #include "common/Helpers.h"
 #include "WidgetShortcuts.h"
+#include "common/RefreshScheduler.h"
 
 #include <QShortcut>
 
@@ -162,13 +163,17 @@ ExportsWidget::~ExportsWidget() {}
 
 void ExportsWidget::refreshExports()
 {
-    exportsModel->beginResetModel();
-    exports = Core()->getAllExports();
-    exportsModel->endResetModel();
+    Core()->getRefreshScheduler()->schedule<QList<ExportDescription>>(this, []() {
+        return Core()->getAllExports();
+    }, [this](const QList<ExportDescription> &exports) {
+        exportsModel->beginResetModel();
+        this->exports = exports;
+        exportsModel->endResetModel();
 
-    qhelpers::adjustColumns(ui->exportsTreeView, 3, 0);
+        qhelpers::adjustColumns(ui->exportsTreeView, 3, 0);
 
-    tree->showItemsNumber(exportsProxyModel->rowCount());
+        tree->showItemsNumber(exportsProxyModel->rowCount());
+    });
 }
 
 
@@ -9,7 +9,7 @@
 #include <QShortcut>
 #include <QTreeWidget>
 
-FlagsModel::FlagsModel(QList<FlagDescription> *flags, QObject *parent)
+FlagsModel::FlagsModel(FlagTable *flags, QObject *parent)
     : QAbstractListModel(parent),
       flags(flags)
 {
@@ -17,7 +17,7 @@ FlagsModel::FlagsModel(QList<FlagDescription> *flags, QObject *parent)
 
 int FlagsModel::rowCount(const QModelIndex &) const
 {
-    return flags->count();
+    return flags->size();
 }
 
 int FlagsModel::columnCount(const QModelIndex &) const
@@ -27,25 +27,25 @@ int FlagsModel::columnCount(const QModelIndex &) const
 
 QVariant FlagsModel::data(const QModelIndex &index, int role) const
 {
-    if (index.row() >= flags->count())
+    if (index.row() >= flags->size())
         return QVariant();
 
-    const FlagDescription &flag = flags->at(index.row());
+    FlagTable::Row flag = flags->at(index.row());
 
     switch (role) {
     case Qt::DisplayRole:
         switch (index.column()) {
         case SIZE:
-            return RSizeString(flag.size);
+            return RSizeString(flag.size());
         case OFFSET:
-            return RAddressString(flag.offset);
+            return RAddressString(flag.offset());
         case NAME:
-            return flag.name;
+            return flag.name();
         default:
             return QVariant();
         }
     case FlagDescriptionRole:
-        return QVariant::fromValue(flag);
+        return QVariant::fromValue(flag.toDescription());
     default:
         return QVariant();
     }
@@ -75,40 +75,59 @@ QVariant FlagsModel::headerData(int section, Qt::Orientation, int role) const
 
 
 FlagsSortFilterProxyModel::FlagsSortFilterProxyModel(FlagsModel *source_model, QObject *parent)
-    : QSortFilterProxyModel(parent)
+    : AsyncSortFilterProxyModel(parent)
 {
     setSourceModel(source_model);
 }
 
-bool FlagsSortFilterProxyModel::filterAcceptsRow(int row, const QModelIndex &parent) const
-{
-    QModelIndex index = sourceModel()->index(row, 0, parent);
-    FlagDescription flag = index.data(FlagsModel::FlagDescriptionRole).value<FlagDescription>();
-    return flag.name.contains(filterRegExp());
-}
+namespace {
 
-bool FlagsSortFilterProxyModel::lessThan(const QModelIndex &left, const QModelIndex &right) const
+class FlagsSnapshot : public AsyncSortFilterProxyModel::Snapshot
 {
-    FlagDescription left_flag = left.data(FlagsModel::FlagDescriptionRole).value<FlagDescription>();
-    FlagDescription right_flag = right.data(FlagsModel::FlagDescriptionRole).value<FlagDescription>();
-
-    switch (left.column()) {
-    case FlagsModel::SIZE:
-        if (left_flag.size != right_flag.size)
-            return left_flag.size < right_flag.size;
-    // fallthrough
-    case FlagsModel::OFFSET:
-        if (left_flag.offset != right_flag.offset)
-            return left_flag.offset < right_flag.offset;
-    // fallthrough
-    case FlagsModel::NAME:
-        return left_flag.name < right_flag.name;
-    default:
-        break;
+public:
+    explicit FlagsSnapshot(const FlagTable &flags)
+        : flags(flags)
+    {
     }
 
-    // fallback
-    return left_flag.offset < right_flag.offset;
+    QString filterText(int row) const override
+    {
+        return flags.at(row).name();
+    }
+
+    bool lessThan(int left, int right, int column) const override
+    {
+        FlagTable::Row left_flag = flags.at(left);
+        FlagTable::Row right_flag = flags.at(right);
+
+        switch (column) {
+        case FlagsModel::SIZE:
+            if (left_flag.size() != right_flag.size())
+                return left_flag.size() < right_flag.size();
+        // fallthrough
+        case FlagsModel::OFFSET:
+            if (left_flag.offset() != right_flag.offset())
+                return left_flag.offset() < right_flag.offset();
+        // fallthrough
+        case FlagsModel::NAME:
+            return flags.compareNames(left, right) < 0;
+        default:
+            break;
+        }
+
+        // fallback
+        return left_flag.offset() < right_flag.offset();
+    }
+
+private:
+    FlagTable flags;
+};
+
+}
+
+AsyncSortFilterProxyModel::Snapshot *FlagsSortFilterProxyModel::createSnapshot() const
+{
+    return new FlagsSnapshot(*static_cast<FlagsModel *>(sourceModel())->flags);
 }
 
 
@@ -146,7 +165,11 @@ FlagsWidget::FlagsWidget(MainWindow *main, QAction *action) :
     });
     clearShortcut->setContext(Qt::WidgetWithChildrenShortcut);
 
-    connect(ui->filterLineEdit, &QLineEdit::textChanged, this, [this] {
+    connect(flags_proxy_model, &AsyncSortFilterProxyModel::sortFilterFinished, this, [this] {
+        if (columnsAdjustPending) {
+            columnsAdjustPending = false;
+            qhelpers::adjustColumns(ui->flagsTreeView, 2, 0);
+        }
         tree->showItemsNumber(flags_proxy_model->rowCount());
     });
         
@@ -242,18 +265,11 @@ void FlagsWidget::refreshFlags()
 
 
     flags_model->beginResetModel();
-    flags = Core()->getAllFlags(flagspace);
+    flags = FlagTable(Core()->getAllFlags(flagspace));
     flags_model->endResetModel();
 
-    qhelpers::adjustColumns(ui->flagsTreeView, 2, 0);
-
-    tree->showItemsNumber(flags_proxy_model->rowCount());
-    
-    // TODO: this is not a very good place for the following:
-    QStringList flagNames;
-    for (const FlagDescription &i : flags)
-        flagNames.append(i.name);
-    main->refreshOmniBar(flagNames);
+    // Rows only show up in the view once they are sorted
+    columnsAdjustPending = true;
 }
 
 void FlagsWidget::setScrollMode()
@@ -4,15 +4,17 @@
 #include <memory>
 
 #include <QAbstractItemModel>
-#include <QSortFilterProxyModel>
 
 #include "core/Cutter.h"
 #include "CutterDockWidget.h"
 #include "CutterTreeWidget.h"
+#include "common/AsyncSortFilterProxyModel.h"
+#include "common/CompactTables.h"
 
 class MainWindow;
 class QTreeWidgetItem;
 class FlagsWidget;
+class FlagsSortFilterProxyModel;
 
 
 class FlagsModel: public QAbstractListModel
@@ -20,15 +22,16 @@ class FlagsModel: public QAbstractListModel
     Q_OBJECT
 
     friend FlagsWidget;
+    friend FlagsSortFilterProxyModel;
 
 private:
-    QList<FlagDescription> *flags;
+    FlagTable *flags;
 
 public:
     enum Columns { OFFSET = 0, SIZE, NAME, COUNT };
     static const int FlagDescriptionRole = Qt::UserRole;
 
-    FlagsModel(QList<FlagDescription> *flags, QObject *parent = nullptr);
+    FlagsModel(FlagTable *flags, QObject *parent = nullptr);
 
     int rowCount(const QModelIndex &parent = QModelIndex()) const;
     int columnCount(const QModelIndex &parent = QModelIndex()) const;
@@ -39,7 +42,7 @@ public:
 
 
 
-class FlagsSortFilterProxyModel : public QSortFilterProxyModel
+class FlagsSortFilterProxyModel : public AsyncSortFilterProxyModel
 {
     Q_OBJECT
 
@@ -47,8 +50,7 @@ public:
     FlagsSortFilterProxyModel(FlagsModel *source_model, QObject *parent = nullptr);
 
 protected:
-    bool filterAcceptsRow(int row, const QModelIndex &parent) const override;
-    bool lessThan(const QModelIndex &left, const QModelIndex &right) const override;
+    Snapshot *createSnapshot() const override;
 };
 
 
@@ -83,8 +85,9 @@ private:
 
     FlagsModel *flags_model;
     FlagsSortFilterProxyModel *flags_proxy_model;
-    QList<FlagDescription> flags;
+    FlagTable flags;
     CutterTreeWidget *tree;
+    bool columnsAdjustPending = false;
 
     void refreshFlags();
     void setScrollMode();
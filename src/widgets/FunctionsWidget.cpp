@@ -17,6 +17,7 @@
 #include <QShortcut>
 #include <QJsonArray>
 #include <QJsonObject>
+#include <QTimer>
 
 namespace {
 
@@ -24,6 +25,19 @@ static const int kMaxTooltipWidth = 400;
 static const int kMaxTooltipDisasmPreviewLines = 10;
 static const int kMaxTooltipHighlightsLines = 5;
 
+bool sameFunction(const FunctionDescription &a, const FunctionDescription &b)
+{
+    return a.offset == b.offset && a.size == b.size && a.nargs == b.nargs && a.nbbs == b.nbbs
+           && a.nlocals == b.nlocals && a.cc == b.cc && a.calltype == b.calltype && a.name == b.name
+           && a.edges == b.edges && a.cost == b.cost && a.calls == b.calls
+           && a.stackframe == b.stackframe;
+}
+
+bool offsetLessThan(const FunctionDescription &a, const FunctionDescription &b)
+{
+    return a.offset < b.offset;
+}
+
 }
 
 FunctionModel::FunctionModel(QList<FunctionDescription> *functions, QSet<RVA> *importAddresses,
@@ -337,6 +351,134 @@ bool FunctionModel::updateCurrentIndex()
     return changed;
 }
 
+int FunctionModel::lowerBoundRow(RVA offset) const
+{
+    FunctionDescription key;
+    key.offset = offset;
+    auto it = std::lower_bound(functions->constBegin(), functions->constEnd(), key, offsetLessThan);
+    return static_cast<int>(it - functions->constBegin());
+}
+
+void FunctionModel::currentIndexMayHaveMoved()
+{
+    // Rows may have shifted, so the previous index can not be repainted by itself
+    updateCurrentIndex();
+    if (currentIndex >= 0) {
+        emit dataChanged(index(currentIndex, 0), index(currentIndex, columnCount() - 1));
+    }
+}
+
+void FunctionModel::setFunctions(QList<FunctionDescription> newFunctions)
+{
+    std::sort(newFunctions.begin(), newFunctions.end(), offsetLessThan);
+
+    if (functions->isEmpty() || nested) {
+        // Nothing to keep, or sub-node indexes refer to their parent by row and would be stale
+        beginResetModel();
+        *functions = newFunctions;
+        updateCurrentIndex();
+        endResetModel();
+        return;
+    }
+
+    int i = 0;
+    int j = 0;
+    int changedFirst = -1;
+    auto flushChanged = [&](int last) {
+        if (changedFirst >= 0) {
+            emit dataChanged(index(changedFirst, 0), index(last, columnCount() - 1));
+            changedFirst = -1;
+        }
+    };
+    while (i < functions->size() || j < newFunctions.size()) {
+        if (j == newFunctions.size()
+                || (i < functions->size() && functions->at(i).offset < newFunctions[j].offset)) {
+            // Run of functions that are gone
+            flushChanged(i - 1);
+            int last = i;
+            while (last + 1 < functions->size()
+                    && (j == newFunctions.size() || functions->at(last + 1).offset < newFunctions[j].offset)) {
+                last++;
+            }
+            beginRemoveRows(QModelIndex(), i, last);
+            functions->erase(functions->begin() + i, functions->begin() + last + 1);
+            endRemoveRows();
+        } else if (i == functions->size() || newFunctions[j].offset < functions->at(i).offset) {
+            // Run of new functions
+            flushChanged(i - 1);
+            int last = j;
+            while (last + 1 < newFunctions.size()
+                    && (i == functions->size() || newFunctions[last + 1].offset < functions->at(i).offset)) {
+                last++;
+            }
+            int count = last - j + 1;
+            beginInsertRows(QModelIndex(), i, i + count - 1);
+            for (int k = 0; k < count; k++) {
+                functions->insert(i + k, newFunctions[j + k]);
+            }
+            endInsertRows();
+            i += count;
+            j += count;
+        } else {
+            if (!sameFunction(functions->at(i), newFunctions[j])) {
+                (*functions)[i] = newFunctions[j];
+                if (changedFirst < 0) {
+                    changedFirst = i;
+                }
+            } else {
+                flushChanged(i - 1);
+            }
+            i++;
+            j++;
+        }
+    }
+    flushChanged(i - 1);
+
+    currentIndexMayHaveMoved();
+}
+
+void FunctionModel::addFunction(const FunctionDescription &function)
+{
+    int row = lowerBoundRow(function.offset);
+    if (row < functions->size() && functions->at(row).offset == function.offset) {
+        (*functions)[row] = function;
+        emit dataChanged(index(row, 0), index(row, columnCount() - 1));
+        return;
+    }
+    if (nested) {
+        // Sub-node indexes after row refer to their parent by row, see setFunctions()
+        beginResetModel();
+        functions->insert(row, function);
+        updateCurrentIndex();
+        endResetModel();
+        return;
+    }
+    beginInsertRows(QModelIndex(), row, row);
+    functions->insert(row, function);
+    endInsertRows();
+    currentIndexMayHaveMoved();
+}
+
+bool FunctionModel::removeFunction(RVA offset)
+{
+    int row = lowerBoundRow(offset);
+    if (row >= functions->size() || functions->at(row).offset != offset) {
+        return false;
+    }
+    if (nested) {
+        beginResetModel();
+        functions->removeAt(row);
+        updateCurrentIndex();
+        endResetModel();
+        return true;
+    }
+    beginRemoveRows(QModelIndex(), row, row);
+    functions->removeAt(row);
+    endRemoveRows();
+    currentIndexMayHaveMoved();
+    return true;
+}
+
 void FunctionModel::functionRenamed(const QString &prev_name, const QString &new_name)
 {
     for (int i = 0; i < functions->count(); i++) {
@@ -355,10 +497,98 @@ FunctionSortFilterProxyModel::FunctionSortFilterProxyModel(FunctionModel *source
     setSourceModel(source_model);
     setFilterCaseSensitivity(Qt::CaseInsensitive);
     setSortCaseSensitivity(Qt::CaseInsensitive);
+
+    connect(source_model, &QAbstractItemModel::modelReset,
+            this, &FunctionSortFilterProxyModel::sourceRowsChanged);
+    connect(source_model, &QAbstractItemModel::rowsInserted,
+            this, &FunctionSortFilterProxyModel::sourceRowsChanged);
+    connect(source_model, &QAbstractItemModel::rowsRemoved,
+            this, &FunctionSortFilterProxyModel::sourceRowsChanged);
+    connect(source_model, &QAbstractItemModel::dataChanged,
+            this, &FunctionSortFilterProxyModel::sourceDataChanged);
+}
+
+void FunctionSortFilterProxyModel::sourceRowsChanged()
+{
+    // Rows shifted, so the ids in the index are wrong until it is rebuilt
+    nameIndexValid = false;
+    candidatesValid = false;
+    scheduleIndexRebuild();
+}
+
+void FunctionSortFilterProxyModel::scheduleIndexRebuild()
+{
+    if (indexTask) {
+        indexTask->interrupt();
+        indexTask.clear();
+    }
+    if (indexRebuildScheduled) {
+        return;
+    }
+    // Coalesce the row changes of one diff into one rebuild
+    indexRebuildScheduled = true;
+    QTimer::singleShot(0, this, [this]() {
+        indexRebuildScheduled = false;
+        QStringList names;
+        const QList<FunctionDescription> &functions = *static_cast<FunctionModel *>(sourceModel())->functions;
+        names.reserve(functions.size());
+        for (const FunctionDescription &function : functions) {
+            names << function.name;
+        }
+        indexTask = QSharedPointer<TrigramIndexTask>(new TrigramIndexTask(names));
+        indexTask->setSupersedeKey(this, QStringLiteral("nameIndex"));
+        TrigramIndexTask *startedTask = indexTask.data();
+        connect(startedTask, &TrigramIndexTask::indexBuilt, this, [this, startedTask](const TrigramIndex &index) {
+            if (startedTask != indexTask.data()) {
+                return;
+            }
+            indexTask.clear();
+            nameIndex = index;
+            nameIndexValid = true;
+            candidatesValid = false;
+        });
+        Core()->getAsyncTaskManager()->start(indexTask);
+    });
+}
+
+void FunctionSortFilterProxyModel::sourceDataChanged(const QModelIndex &topLeft,
+                                                     const QModelIndex &bottomRight)
+{
+    if (!nameIndexValid || topLeft.parent().isValid()) {
+        return;
+    }
+    const QList<FunctionDescription> &functions = *static_cast<FunctionModel *>(sourceModel())->functions;
+    bool renamed = false;
+    for (int row = topLeft.row(); row <= bottomRight.row() && row < functions.size(); row++) {
+        // Most changes only concern highlighting and leave the name alone
+        if (nameIndex.update(row, functions[row].name)) {
+            renamed = true;
+        }
+    }
+    if (renamed && candidatesValid) {
+        candidatesValid = false;
+        // The changed rows were already filtered with the outdated candidates
+        invalidateFilter();
+    }
 }
 
 bool FunctionSortFilterProxyModel::filterAcceptsRow(int row, const QModelIndex &parent) const
 {
+    if (!parent.isValid() && nameIndexValid && nameIndex.size() == sourceModel()->rowCount()) {
+        if (!candidatesValid || candidatesFilter != filterRegExp()) {
+            candidatesFilter = filterRegExp();
+            QVector<int> candidates;
+            candidatesNarrowed = nameIndex.candidates(candidatesFilter, &candidates);
+            candidateRows.fill(false, candidatesNarrowed ? nameIndex.size() : 0);
+            for (int candidate : candidates) {
+                candidateRows[candidate] = true;
+            }
+            candidatesValid = true;
+        }
+        if (candidatesNarrowed && !candidateRows.value(row)) {
+            return false;
+        }
+    }
     QModelIndex index = sourceModel()->index(row, 0, parent);
     FunctionDescription function = index.data(
                                        FunctionModel::FunctionDescriptionRole).value<FunctionDescription>();
@@ -504,7 +734,9 @@ FunctionsWidget::FunctionsWidget(MainWindow *main, QAction *action) :
     connect(this, SIGNAL(customContextMenuRequested(const QPoint &)),
             this, SLOT(showTitleContextMenu(const QPoint &)));
 
-    connect(Core(), SIGNAL(functionsChanged()), this, SLOT(refreshTree()));
+    connect(Core(), &CutterCore::functionAdded, this, &FunctionsWidget::onFunctionAdded);
+    connect(Core(), &CutterCore::functionRemoved, this, &FunctionsWidget::onFunctionRemoved);
+    connect(Core(), SIGNAL(functionsChanged()), this, SLOT(onFunctionsChanged()));
     connect(Core(), SIGNAL(refreshAll()), this, SLOT(refreshTree()));
 }
 
@@ -512,26 +744,31 @@ FunctionsWidget::~FunctionsWidget() {}
 
 void FunctionsWidget::refreshTree()
 {
-    if (task) {
-        task->wait();
-    }
-
+    // A fetch still running for an earlier refresh is superseded by this one
     task = QSharedPointer<FunctionsTask>(new FunctionsTask());
-    connect(task.data(), &FunctionsTask::fetchFinished,
-    this, [this] (const QList<FunctionDescription> &functions) {
-        functionModel->beginResetModel();
-
-        this->functions = functions;
-
-        importAddresses.clear();
+    task->setSupersedeKey(this, QStringLiteral("functions"));
+    FunctionsTask *startedTask = task.data();
+    connect(startedTask, &FunctionsTask::fetchFinished,
+    this, [this, startedTask] (const QList<FunctionDescription> &functions) {
+        if (startedTask != task.data()) {
+            return;
+        }
+        QSet<RVA> newImportAddresses;
         for (const ImportDescription &import : Core()->getAllImports()) {
-            importAddresses.insert(import.plt);
+            newImportAddresses.insert(import.plt);
+        }
+        ut64 newMainAdress = (ut64)Core()->cmdj("iMj").object()["vaddr"].toInt();
+        bool decorationChanged = newImportAddresses != importAddresses || newMainAdress != mainAdress;
+        importAddresses = newImportAddresses;
+        mainAdress = newMainAdress;
+
+        // Only the differences reach the view, so scroll position and selection are kept
+        functionModel->setFunctions(functions);
+        if (decorationChanged && !this->functions.isEmpty()) {
+            emit functionModel->dataChanged(functionModel->index(0, 0),
+                                            functionModel->index(this->functions.count() - 1,
+                                                                 functionModel->columnCount() - 1));
         }
-
-        mainAdress = (ut64)Core()->cmdj("iMj").object()["vaddr"].toInt();
-
-        functionModel->updateCurrentIndex();
-        functionModel->endResetModel();
 
         // resize offset and size columns
         qhelpers::adjustColumns(ui->functionsTreeView, 3, 0);
@@ -541,6 +778,37 @@ void FunctionsWidget::refreshTree()
     Core()->getAsyncTaskManager()->start(task);
 }
 
+void FunctionsWidget::onFunctionAdded(RVA addr)
+{
+    bool ok;
+    FunctionDescription function = Core()->getFunctionDescription(addr, &ok);
+    if (!ok) {
+        // Let the following functionsChanged() fetch everything
+        return;
+    }
+    functionModel->addFunction(function);
+    functionsChangedHandled = true;
+    tree->showItemsNumber(functionProxyModel->rowCount());
+}
+
+void FunctionsWidget::onFunctionRemoved(RVA addr)
+{
+    // addr may also point inside of the function, then everything is fetched again
+    if (functionModel->removeFunction(addr)) {
+        functionsChangedHandled = true;
+        tree->showItemsNumber(functionProxyModel->rowCount());
+    }
+}
+
+void FunctionsWidget::onFunctionsChanged()
+{
+    if (functionsChangedHandled) {
+        functionsChangedHandled = false;
+        return;
+    }
+    refreshTree();
+}
+
 void FunctionsWidget::changeSizePolicy(QSizePolicy::Policy hor, QSizePolicy::Policy ver)
 {
     ui->dockWidgetContents->setSizePolicy(hor, ver);
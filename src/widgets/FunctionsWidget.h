@@ -9,6 +9,7 @@
 #include "CutterDockWidget.h"
 #include "CutterTreeWidget.h"
 #include "CutterTreeView.h"
+#include "common/TrigramIndex.h"
 
 class MainWindow;
 class QTreeWidgetItem;
@@ -25,6 +26,7 @@ class FunctionModel : public QAbstractItemModel
     Q_OBJECT
 
     friend FunctionsWidget;
+    friend class FunctionSortFilterProxyModel;
 
 private:
     QList<FunctionDescription> *functions;
@@ -42,6 +44,9 @@ private:
 
     bool functionIsMain(ut64 addr) const;
 
+    int lowerBoundRow(RVA offset) const;
+    void currentIndexMayHaveMoved();
+
 public:
     static const int FunctionDescriptionRole = Qt::UserRole;
     static const int IsImportRole = Qt::UserRole + 1;
@@ -74,6 +79,18 @@ public:
         return nested;
     }
 
+    /**
+     * @brief Replace all functions, only notifying views about the rows that actually changed
+     *
+     * Functions are kept sorted by offset, so the new list is merged against the current one.
+     */
+    void setFunctions(QList<FunctionDescription> functions);
+    void addFunction(const FunctionDescription &function);
+    /**
+     * @return false if there is no function starting at offset
+     */
+    bool removeFunction(RVA offset);
+
 private slots:
     void seekChanged(RVA addr);
     void functionRenamed(const QString &prev_name, const QString &new_name);
@@ -90,6 +107,28 @@ public:
 protected:
     bool filterAcceptsRow(int row, const QModelIndex &parent) const override;
     bool lessThan(const QModelIndex &left, const QModelIndex &right) const override;
+
+private:
+    /**
+     * Index of the function names by row, rebuilt in the background when rows are added or
+     * removed and updated in place on renames. Rows which are not candidates for the current
+     * filter are rejected without matching the name.
+     */
+    TrigramIndex nameIndex;
+    bool nameIndexValid = false;
+    QSharedPointer<TrigramIndexTask> indexTask;
+    bool indexRebuildScheduled = false;
+
+    mutable QRegExp candidatesFilter;
+    mutable bool candidatesValid = false;
+    mutable bool candidatesNarrowed = false;
+    mutable QVector<bool> candidateRows;
+
+    void scheduleIndexRebuild();
+
+private slots:
+    void sourceRowsChanged();
+    void sourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight);
 };
 
 
@@ -115,6 +154,9 @@ private slots:
     void showTitleContextMenu(const QPoint &pt);
     void setTooltipStylesheet();
     void refreshTree();
+    void onFunctionAdded(RVA addr);
+    void onFunctionRemoved(RVA addr);
+    void onFunctionsChanged();
 
 protected:
     void resizeEvent(QResizeEvent *event) override;
@@ -126,6 +168,10 @@ private:
     QList<FunctionDescription> functions;
     QSet<RVA> importAddresses;
     ut64 mainAdress;
+    /**
+     * Set when the pending functionsChanged() was already applied from a single function event
+     */
+    bool functionsChangedHandled = false;
     FunctionModel *functionModel;
     FunctionSortFilterProxyModel *functionProxyModel;
     CutterTreeWidget *tree;
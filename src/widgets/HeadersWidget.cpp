@@ -2,6 +2,7 @@
 #include "ui_HeadersWidget.h"
 #include "core/MainWindow.h"
 #include "common/Helpers.h"
+#include "common/RefreshScheduler.h"
 
 HeadersModel::HeadersModel(QList<HeaderDescription> *headers, QObject *parent)
     : QAbstractListModel(parent),
@@ -118,12 +119,16 @@ HeadersWidget::~HeadersWidget() {}
 
 void HeadersWidget::refreshHeaders()
 {
-    headersModel->beginResetModel();
-    headers = Core()->getAllHeaders();
-    headersModel->endResetModel();
-
-    ui->headersTreeView->resizeColumnToContents(0);
-    ui->headersTreeView->resizeColumnToContents(1);
+    Core()->getRefreshScheduler()->schedule<QList<HeaderDescription>>(this, []() {
+        return Core()->getAllHeaders();
+    }, [this](const QList<HeaderDescription> &headers) {
+        headersModel->beginResetModel();
+        this->headers = headers;
+        headersModel->endResetModel();
+
+        ui->headersTreeView->resizeColumnToContents(0);
+        ui->headersTreeView->resizeColumnToContents(1);
+    });
 }
 
 void HeadersWidget::setScrollMode()
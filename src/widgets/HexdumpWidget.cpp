@@ -4,6 +4,7 @@
 #include "common/Helpers.h"
 #include "common/Configuration.h"
 #include "common/TempConfig.h"
+#include "core/MainWindow.h"
 
 #include <QJsonObject>
 #include <QJsonArray>
@@ -17,6 +18,7 @@
 
 HexdumpWidget::HexdumpWidget(MainWindow *main, QAction *action) :
     MemoryDockWidget(CutterCore::MemoryWidgetType::Hexdump, main, action),
+    main(main),
     ui(new Ui::HexdumpWidget),
     seekable(new CutterSeekable(this))
 {
@@ -105,6 +107,14 @@ HexdumpWidget::HexdumpWidget(MainWindow *main, QAction *action) :
 
     connect(&syncAction, SIGNAL(triggered(bool)), this, SLOT(toggleSync()));
 
+    exportSelectionAction.setText(tr("Export selection as code..."));
+    connect(&exportSelectionAction, &QAction::triggered, this, [this]() {
+        if (selectionEndAddress > selectionStartAddress) {
+            this->main->exportAsCode(selectionStartAddress, selectionEndAddress - selectionStartAddress,
+                                     false);
+        }
+    });
+
     // Set hexdump context menu
     ui->hexHexText->setContextMenuPolicy(Qt::CustomContextMenu);
     connect(ui->hexHexText, SIGNAL(customContextMenuRequested(const QPoint &)),
@@ -518,6 +528,7 @@ void HexdumpWidget::selectionChanged()
         QTextCursor textCursor = ui->hexHexText->textCursor();
         if (!textCursor.hasSelection()) {
             clearParseWindow();
+            selectionStartAddress = selectionEndAddress = RVA_INVALID;
             RVA adr = hexPositionToAddress(textCursor.position());
             int pos = asciiAddressToPosition(adr);
             setTextEditPosition(ui->hexASCIIText, pos);
@@ -564,6 +575,8 @@ void HexdumpWidget::selectionChanged()
         RVA startAddress = hexPositionToAddress(selectionStart);
         RVA endAddress = hexPositionToAddress(selectionEnd);
 
+        selectionStartAddress = startAddress;
+        selectionEndAddress = endAddress;
         updateParseWindow(startAddress, endAddress - startAddress);
 
         int startPosition = asciiAddressToPosition(startAddress);
@@ -579,6 +592,7 @@ void HexdumpWidget::selectionChanged()
         QTextCursor textCursor = ui->hexASCIIText->textCursor();
         if (!textCursor.hasSelection()) {
             clearParseWindow();
+            selectionStartAddress = selectionEndAddress = RVA_INVALID;
             RVA adr = asciiPositionToAddress(textCursor.position());
             int pos = hexAddressToPosition(adr);
             setTextEditPosition(ui->hexHexText, pos);
@@ -591,6 +605,8 @@ void HexdumpWidget::selectionChanged()
         RVA startAddress = asciiPositionToAddress(textCursor.selectionStart());
         RVA endAddress = asciiPositionToAddress(textCursor.selectionEnd());
 
+        selectionStartAddress = startAddress;
+        selectionEndAddress = endAddress;
         updateParseWindow(startAddress, endAddress - startAddress);
 
         int startPosition = hexAddressToPosition(startAddress);
@@ -648,6 +664,10 @@ void HexdumpWidget::showHexdumpContextMenu(const QPoint &pt)
 
     menu->addAction(ui->actionSelect_Block);
 
+    exportSelectionAction.setEnabled(selectionEndAddress > selectionStartAddress
+                                     && selectionStartAddress != RVA_INVALID);
+    menu->addAction(&exportSelectionAction);
+
     menu->addSeparator();
     syncAction.setText(tr("Sync/unsync offset"));
     menu->addAction(&syncAction);
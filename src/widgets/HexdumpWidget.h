@@ -67,6 +67,7 @@ private:
 
     enum Format format = Format::Hex;
 
+    MainWindow *main;
     std::unique_ptr<Ui::HexdumpWidget> ui;
 
     bool sent_seek = false;
@@ -112,8 +113,11 @@ private:
     int cols = 0;
     ut64 requestedSelectionStartAddress=0;
     ut64 requestedSelectionEndAddress=0;
+    RVA selectionStartAddress = RVA_INVALID;
+    RVA selectionEndAddress = RVA_INVALID;
     HexdumpRangeDialog  rangeDialog;
     QAction syncAction;
+    QAction exportSelectionAction;
     CutterSeekable *seekable;
     qreal defaultFontSize;
 
@@ -3,6 +3,7 @@
 #include "WidgetShortcuts.h"
 #include "core/MainWindow.h"
 #include "common/Helpers.h"
+#include "common/RefreshScheduler.h"
 
 #include <QPainter>
 #include <QPen>
@@ -176,12 +177,16 @@ ImportsWidget::~ImportsWidget() {}
 
 void ImportsWidget::refreshImports()
 {
-    importsModel->beginResetModel();
-    imports = Core()->getAllImports();
-    importsModel->endResetModel();
-    qhelpers::adjustColumns(ui->importsTreeView, 4, 0);
+    Core()->getRefreshScheduler()->schedule<QList<ImportDescription>>(this, []() {
+        return Core()->getAllImports();
+    }, [this](const QList<ImportDescription> &imports) {
+        importsModel->beginResetModel();
+        this->imports = imports;
+        importsModel->endResetModel();
+        qhelpers::adjustColumns(ui->importsTreeView, 4, 0);
 
-    tree->showItemsNumber(importsProxyModel->rowCount());
+        tree->showItemsNumber(importsProxyModel->rowCount());
+    });
 }
 
 void ImportsWidget::setScrollMode()
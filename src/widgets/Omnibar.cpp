@@ -1,10 +1,87 @@
 #include "Omnibar.h"
 #include "core/MainWindow.h"
 
-#include <QStringListModel>
+#include <QAbstractListModel>
 #include <QCompleter>
 #include <QShortcut>
 #include <QAbstractItemView>
+#include <QTimer>
+
+// Only the best matches are ever shown, so there is no need to look for more
+static const int maxCompletions = 50;
+
+/**
+ * @brief Holds just the current matches of the Omnibar instead of all names
+ */
+class OmnibarCompletionModel : public QAbstractListModel
+{
+public:
+    using QAbstractListModel::QAbstractListModel;
+
+    void setMatches(const QVector<CompletionIndex::Match> &matches, RVA expressionValue)
+    {
+        beginResetModel();
+        this->matches = matches;
+        this->expressionValue = expressionValue;
+        endResetModel();
+    }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override
+    {
+        return parent.isValid() ? 0 : matches.size();
+    }
+
+    QVariant data(const QModelIndex &index, int role) const override
+    {
+        if (!index.isValid() || index.row() >= matches.size()) {
+            return QVariant();
+        }
+        const CompletionIndex::Match &match = matches.at(index.row());
+        switch (role) {
+        case Qt::DisplayRole:
+            if (match.kind == CompletionIndex::Kind::Expression) {
+                return QString("%1 = %2").arg(match.text, RAddressString(expressionValue));
+            }
+            return match.text;
+        case Qt::EditRole:
+            return match.text;
+        case Qt::ToolTipRole:
+            switch (match.kind) {
+            case CompletionIndex::Kind::Flag:
+                return Omnibar::tr("Flag");
+            case CompletionIndex::Kind::Function:
+                return Omnibar::tr("Function");
+            case CompletionIndex::Kind::Section:
+                return Omnibar::tr("Section");
+            case CompletionIndex::Kind::Expression:
+                return Omnibar::tr("Expression");
+            }
+            return QVariant();
+        default:
+            return QVariant();
+        }
+    }
+
+private:
+    QVector<CompletionIndex::Match> matches;
+    RVA expressionValue = RVA_INVALID;
+};
+
+static bool looksLikeExpression(const QString &text)
+{
+    if (text.isEmpty()) {
+        return false;
+    }
+    if (text[0].isDigit() || text[0] == QLatin1Char('$')) {
+        return true;
+    }
+    for (QChar c : text) {
+        if (QString("+-*/()").contains(c)) {
+            return true;
+        }
+    }
+    return false;
+}
 
 
 Omnibar::Omnibar(MainWindow *main, QWidget *parent) :
@@ -20,40 +97,97 @@ Omnibar::Omnibar(MainWindow *main, QWidget *parent) :
     this->setClearButtonEnabled(true);
 
     connect(this, SIGNAL(returnPressed()), this, SLOT(on_gotoEntry_returnPressed()));
+    connect(this, &QLineEdit::textEdited, this, &Omnibar::updateCompletions);
 
     // Esc clears omnibar
     QShortcut *clear_shortcut = new QShortcut(QKeySequence(Qt::Key_Escape), this);
     connect(clear_shortcut, SIGNAL(activated()), this, SLOT(clear()));
     clear_shortcut->setContext(Qt::WidgetWithChildrenShortcut);
+
+    setupCompleter();
+
+    connect(Core(), &CutterCore::refreshAll, this, &Omnibar::scheduleIndexRebuild);
+    connect(Core(), &CutterCore::flagsChanged, this, &Omnibar::scheduleIndexRebuild);
+    connect(Core(), &CutterCore::functionsChanged, this, &Omnibar::scheduleIndexRebuild);
+    connect(Core(), &CutterCore::functionRenamed, this, &Omnibar::scheduleIndexRebuild);
 }
 
 void Omnibar::setupCompleter()
 {
-    // Set gotoEntry completer for jump history
-    QCompleter *completer = new QCompleter(flags, this);
+    completionModel = new OmnibarCompletionModel(this);
+
+    // Matching and ranking is done by the index, the completer only shows the results
+    completer = new QCompleter(completionModel, this);
     completer->setMaxVisibleItems(20);
-    completer->setCompletionMode(QCompleter::PopupCompletion);
-    completer->setModelSorting(QCompleter::CaseSensitivelySortedModel);
+    completer->setCompletionMode(QCompleter::UnfilteredPopupCompletion);
     completer->setCaseSensitivity(Qt::CaseInsensitive);
-    completer->setFilterMode(Qt::MatchContains);
 
     this->setCompleter(completer);
 }
 
-void Omnibar::refresh(const QStringList &flagList)
+void Omnibar::scheduleIndexRebuild()
 {
-    flags = flagList;
+    if (indexRebuildScheduled) {
+        return;
+    }
+    // Renaming or analysis emits many changes at once, they all go into one rebuild
+    indexRebuildScheduled = true;
+    QTimer::singleShot(0, this, &Omnibar::rebuildIndex);
+}
 
-    setupCompleter();
+void Omnibar::rebuildIndex()
+{
+    indexRebuildScheduled = false;
+    indexTask = QSharedPointer<CompletionIndexTask>(new CompletionIndexTask());
+    indexTask->setSupersedeKey(this, QStringLiteral("completionIndex"));
+    CompletionIndexTask *startedTask = indexTask.data();
+    connect(startedTask, &CompletionIndexTask::indexBuilt, this,
+    [this, startedTask](const CompletionIndex &index) {
+        if (startedTask != indexTask.data()) {
+            return;
+        }
+        indexTask.clear();
+        // The previous index stays in use until this point
+        this->index = index;
+    });
+    Core()->getAsyncTaskManager()->start(indexTask);
 }
 
-void Omnibar::restoreCompleter()
+void Omnibar::updateCompletions(const QString &text)
 {
-    QCompleter *completer = this->completer();
-    if (!completer) {
+    if (queryTask) {
+        queryTask->interrupt();
+        queryTask.clear();
+    }
+
+    if (text.isEmpty()) {
+        completionModel->setMatches({}, RVA_INVALID);
         return;
     }
-    completer->setFilterMode(Qt::MatchContains);
+
+    bool evaluate = looksLikeExpression(text);
+    queryTask = QSharedPointer<CompletionQueryTask>(new CompletionQueryTask(index, text, maxCompletions,
+                                                                            evaluate));
+    queryTask->setSupersedeKey(this, QStringLiteral("completionQuery"));
+    CompletionQueryTask *startedTask = queryTask.data();
+    connect(startedTask, &CompletionQueryTask::queryFinished, this,
+            [this, startedTask, evaluate](const QString &query,
+                                          const QVector<CompletionIndex::Match> &matches,
+                                          RVA expressionValue) {
+        if (startedTask != queryTask.data() || query != this->text()) {
+            return;
+        }
+        queryTask.clear();
+        QVector<CompletionIndex::Match> shown;
+        if (evaluate) {
+            shown.append(CompletionIndex::Match { query, CompletionIndex::Kind::Expression });
+        }
+        completionModel->setMatches(shown + matches, expressionValue);
+        if (hasFocus() && completionModel->rowCount() > 0) {
+            completer->complete();
+        }
+    });
+    Core()->getAsyncTaskManager()->start(queryTask);
 }
 
 void Omnibar::clear()
@@ -74,5 +208,4 @@ void Omnibar::on_gotoEntry_returnPressed()
 
     this->setText("");
     this->clearFocus();
-    this->restoreCompleter();
 }
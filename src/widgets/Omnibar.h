@@ -1,9 +1,13 @@
 #ifndef OMNIBAR_H
 #define OMNIBAR_H
 
+#include "common/CompletionIndex.h"
+
 #include <QLineEdit>
 
 class MainWindow;
+class QCompleter;
+class OmnibarCompletionModel;
 
 class Omnibar : public QLineEdit
 {
@@ -11,21 +15,30 @@ class Omnibar : public QLineEdit
 public:
     explicit Omnibar(MainWindow *main, QWidget *parent = nullptr);
 
-    void refresh(const QStringList &flagList);
-
 private slots:
     void on_gotoEntry_returnPressed();
 
-    void restoreCompleter();
+    void scheduleIndexRebuild();
+    void updateCompletions(const QString &text);
 
 public slots:
     void clear();
 
 private:
     void setupCompleter();
+    void rebuildIndex();
 
     MainWindow          *main;
-    QStringList         flags;
+    QCompleter          *completer;
+    OmnibarCompletionModel *completionModel;
+
+    /**
+     * Names of all flags, functions and sections, rebuilt in the background when they change
+     */
+    CompletionIndex index;
+    QSharedPointer<CompletionIndexTask> indexTask;
+    bool indexRebuildScheduled = false;
+    QSharedPointer<CompletionQueryTask> queryTask;
 };
 
 #endif // OMNIBAR_H
@@ -2,6 +2,7 @@
 #include "ui_RelocsWidget.h"
 #include "core/MainWindow.h"
 #include "common/Helpers.h"
+#include "common/RefreshScheduler.h"
 
 #include <QShortcut>
 #include <QTreeWidget>
@@ -152,12 +153,16 @@ void RelocsWidget::on_relocsTreeView_doubleClicked(const QModelIndex &index)
 
 void RelocsWidget::refreshRelocs()
 {
-    relocsModel->beginResetModel();
-    relocs = Core()->getAllRelocs();
-    relocsModel->endResetModel();
-    qhelpers::adjustColumns(ui->relocsTreeView, 3, 0);
+    Core()->getRefreshScheduler()->schedule<QList<RelocDescription>>(this, []() {
+        return Core()->getAllRelocs();
+    }, [this](const QList<RelocDescription> &relocs) {
+        relocsModel->beginResetModel();
+        this->relocs = relocs;
+        relocsModel->endResetModel();
+        qhelpers::adjustColumns(ui->relocsTreeView, 3, 0);
 
-    tree->showItemsNumber(relocsProxyModel->rowCount());
+        tree->showItemsNumber(relocsProxyModel->rowCount());
+    });
 }
 
 void RelocsWidget::setScrollMode()
@@ -1,6 +1,7 @@
 #include "common/Helpers.h"
 #include "ResourcesWidget.h"
 #include "core/MainWindow.h"
+#include "common/RefreshScheduler.h"
 #include <QVBoxLayout>
 
 ResourcesModel::ResourcesModel(QList<ResourcesDescription> *resources, QObject *parent)
@@ -96,9 +97,13 @@ ResourcesWidget::ResourcesWidget(MainWindow *main, QAction *action) :
 
 void ResourcesWidget::refreshResources()
 {
-    model->beginResetModel();
-    resources = Core()->getAllResources();
-    model->endResetModel();
+    Core()->getRefreshScheduler()->schedule<QList<ResourcesDescription>>(this, []() {
+        return Core()->getAllResources();
+    }, [this](const QList<ResourcesDescription> &resources) {
+        model->beginResetModel();
+        this->resources = resources;
+        model->endResetModel();
+    });
 }
 
 void ResourcesWidget::onDoubleClicked(const QModelIndex &index)
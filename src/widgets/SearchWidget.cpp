@@ -2,17 +2,31 @@
 #include "ui_SearchWidget.h"
 #include "core/MainWindow.h"
 #include "common/Helpers.h"
+#include "common/PatternSearchTask.h"
+#include "common/RefineSearchTask.h"
 
 #include <QDockWidget>
 #include <QTreeWidget>
 #include <QComboBox>
+#include <QCheckBox>
 #include <QShortcut>
+#include <QPushButton>
+#include <QFile>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QMessageBox>
 
 namespace {
 
 static const int kMaxTooltipWidth = 500;
 static const int kMaxTooltipDisasmPreviewLines = 10;
 static const int kMaxTooltipHexdumpBytes = 64;
+// More hits are only searched for on request
+static const int kMaxSearchHits = 10000;
+// Searched by a PatternSearchTask instead of an r2 command
+static const QString kPatternSearchSpace = QStringLiteral("patterns");
+// Total number of hits kept in the search cache
+static const int kMaxCachedHits = 200000;
 
 }
 
@@ -160,9 +174,40 @@ bool SearchSortFilterProxyModel::lessThan(const QModelIndex &left, const QModelI
 
 SearchWidget::SearchWidget(MainWindow *main, QAction *action) :
     CutterDockWidget(main, action),
-    ui(new Ui::SearchWidget)
+    ui(new Ui::SearchWidget),
+    tree(new CutterTreeWidget(this))
 {
     ui->setupUi(this);
+
+    // Add Status Bar footer
+    tree->addStatusBar(ui->verticalLayout);
+
+    continueButton = new QPushButton(tr("Continue"), this);
+    continueButton->setToolTip(tr("Search for more hits after the last one shown"));
+    continueButton->hide();
+    ui->horizontalLayout_17->insertWidget(ui->horizontalLayout_17->indexOf(ui->searchButton) + 1,
+                                          continueButton);
+    connect(continueButton, &QAbstractButton::clicked, this, [this]() {
+        continueButton->hide();
+        // The continued search gets its own cache key, so refinements of the capped hits stay valid
+        pendingKey = resultsKey.isEmpty() ? QString() : resultsKey + QStringLiteral("+");
+        resultsKey.clear();
+        QList<SearchTask::Range> ranges = SearchTask::rangesFrom(searchRanges, resumeAddress);
+        resumeAddress = RVA_INVALID;
+        startSearch(ranges);
+    });
+
+    refineCheckBox = new QCheckBox(tr("Refine"), this);
+    refineCheckBox->setToolTip(tr("Only search at the addresses of the current hits"));
+    ui->horizontalLayout_17->insertWidget(ui->horizontalLayout_17->indexOf(continueButton) + 1,
+                                          refineCheckBox);
+
+    loadPatternsButton = new QPushButton(tr("Load Patterns..."), this);
+    loadPatternsButton->setToolTip(tr("Search for all patterns in a file, one per line"));
+    loadPatternsButton->hide();
+    ui->horizontalLayout_17->insertWidget(ui->horizontalLayout_17->indexOf(ui->searchspaceCombo) + 1,
+                                          loadPatternsButton);
+    connect(loadPatternsButton, &QAbstractButton::clicked, this, &SearchWidget::loadPatterns);
     setStyleSheet(QString("QToolTip { max-width: %1px; opacity: 230; }").arg(kMaxTooltipWidth));
 
     ui->searchInCombo->blockSignals(true);
@@ -178,6 +223,20 @@ SearchWidget::SearchWidget(MainWindow *main, QAction *action) :
 
     setScrollMode();
 
+    searchCache.setMaxCost(kMaxCachedHits);
+    // Hits of a previous search may be gone after a patch or a debugger step
+    connect(Core(), &CutterCore::instructionChanged, this, [this]() {
+        searchEpoch++;
+    });
+    connect(Core(), &CutterCore::registersChanged, this, [this]() {
+        searchEpoch++;
+    });
+    // Nothing of a previously opened file may be shown, cached or refined
+    connect(Core(), &CutterCore::refreshAll, this, [this]() {
+        searchEpoch++;
+        searchCache.clear();
+        clearResults();
+    });
     connect(Core(), SIGNAL(refreshAll()), this, SLOT(refreshSearchspaces()));
 
     QShortcut *enter_press = new QShortcut(QKeySequence(Qt::Key_Return), this);
@@ -187,7 +246,12 @@ SearchWidget::SearchWidget(MainWindow *main, QAction *action) :
     enter_press->setContext(Qt::WidgetWithChildrenShortcut);
 
     connect(ui->searchButton, &QAbstractButton::clicked, this, [this]() {
-        refreshSearch();
+        // The button stops a running search
+        if (task) {
+            stopSearch();
+        } else {
+            refreshSearch();
+        }
     });
 
     connect(ui->searchspaceCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
@@ -197,7 +261,12 @@ SearchWidget::SearchWidget(MainWindow *main, QAction *action) :
     ui->searchInCombo->setCurrentIndex(ui->searchInCombo->findData(currentSearchBoundary));
 }
 
-SearchWidget::~SearchWidget() {}
+SearchWidget::~SearchWidget()
+{
+    if (task) {
+        task->interrupt();
+    }
+}
 
 void SearchWidget::on_searchTreeView_doubleClicked(const QModelIndex &index)
 {
@@ -226,6 +295,7 @@ void SearchWidget::refreshSearchspaces()
     ui->searchspaceCombo->addItem(tr("hex string"), QVariant("/xj"));
     ui->searchspaceCombo->addItem(tr("ROP gadgets"), QVariant("/Rj"));
     ui->searchspaceCombo->addItem(tr("32bit value"), QVariant("/vj"));
+    ui->searchspaceCombo->addItem(tr("byte patterns"), QVariant(kPatternSearchSpace));
 
     if (cur_idx > 0)
         ui->searchspaceCombo->setCurrentIndex(cur_idx);
@@ -239,11 +309,256 @@ void SearchWidget::refreshSearch()
     QVariant searchspace_data = ui->searchspaceCombo->currentData();
     QString searchspace = searchspace_data.toString();
 
+    // A refinement starts from the hits shown, even those of a search stopped early
+    stopSearch();
+    bool refine = refineCheckBox->isChecked() && !search.isEmpty();
+    QList<SearchDescription> base = refine ? search : QList<SearchDescription>();
+    QString baseKey = resultsKey;
+    clearResults();
+
+    bool code = searchspace == "/cj" || searchspace == "/Rj";
+    QList<PatternMatcher::Pattern> patterns;
+    if (search_for.isEmpty() && !(searchspace == kPatternSearchSpace && !loadedPatterns.isEmpty())) {
+        updateItemsNumber();
+        return;
+    }
+    if ((searchspace == kPatternSearchSpace || (refine && !code))
+            && !parsePatterns(searchspace, search_for, &patterns)) {
+        updateItemsNumber();
+        return;
+    }
+
+    QString key = QString("%1\n%2\n%3\n").arg(searchEpoch).arg(searchspace,
+                                                               Core()->getConfig("search.in"));
+    key += search_for.isEmpty() ? QString("\n%1").arg(loadedPatternsSerial) : search_for;
+    if (refine) {
+        // Refinements of incomplete hits are not cached
+        key = baseKey.isEmpty() ? QString()
+              : baseKey + QString("\n>%1\n").arg(base.size()) + key;
+    }
+    searchFor = search_for;
+    searchSpace = searchspace;
+    searchPatterns = patterns;
+    if (!key.isEmpty() && restoreCachedSearch(key)) {
+        return;
+    }
+    pendingKey = key;
+
+    if (refine && code) {
+        // Disassembling at the hits again would give the same, so they are filtered by their code
+        search_model->beginResetModel();
+        for (const SearchDescription &hit : base) {
+            if (hit.code.contains(search_for, Qt::CaseInsensitive)) {
+                search << hit;
+            }
+        }
+        search_model->endResetModel();
+        searchRanges.clear();
+        cacheResults();
+        qhelpers::adjustColumns(ui->searchTreeView, 3, 0);
+        updateItemsNumber();
+        return;
+    }
+    if (refine) {
+        refineBase = base;
+        startSearch({ SearchTask::Range(0, RVA_MAX) });
+        return;
+    }
+    startSearch(Core()->getSearchBoundaries());
+}
+
+void SearchWidget::startSearch(const QList<SearchTask::Range> &ranges)
+{
+    searchRanges = ranges;
+    if (!refineBase.isEmpty()) {
+        QList<SearchDescription> hits;
+        for (const SearchDescription &hit : refineBase) {
+            if (!ranges.isEmpty() && hit.offset >= ranges.first().first) {
+                hits << hit;
+            }
+        }
+        task = QSharedPointer<SearchTask>(new RefineSearchTask(hits, searchPatterns, kMaxSearchHits));
+    } else if (searchSpace == kPatternSearchSpace) {
+        task = QSharedPointer<SearchTask>(new PatternSearchTask(searchPatterns, ranges, kMaxSearchHits));
+    } else {
+        task = QSharedPointer<SearchTask>(new SearchTask(searchFor, searchSpace, ranges, kMaxSearchHits));
+    }
+    task->setSupersedeKey(this, QStringLiteral("search"));
+    connect(task.data(), &SearchTask::hitsFound, this, &SearchWidget::hitsFound);
+    connect(task.data(), &SearchTask::hitLimitReached, this, [this](RVA address) {
+        if (sender() != task.data()) {
+            return;
+        }
+        resumeAddress = address;
+        continueButton->show();
+    });
+    // Searching large ranges can take a while without any hits, so the "% done" follows the task
+    connect(task.data(), &AsyncTask::progressChanged, this, [this]() {
+        if (sender() != task.data()) {
+            return;
+        }
+        updateItemsNumber();
+    });
+    connect(task.data(), &AsyncTask::finished, this, &SearchWidget::searchFinished);
+    ui->searchButton->setText(tr("Stop"));
+    Core()->getAsyncTaskManager()->start(task);
+}
+
+void SearchWidget::stopSearch()
+{
+    if (!task) {
+        return;
+    }
+    // Hits found so far stay, queued ones of the old task are dropped in hitsFound
+    task->interrupt();
+    task.clear();
+    // The hits are incomplete, so they are neither cached nor a base for cached refinements
+    pendingKey.clear();
+    ui->searchButton->setText(tr("Search"));
+    updateItemsNumber();
+}
+
+void SearchWidget::clearResults()
+{
+    stopSearch();
     search_model->beginResetModel();
-    search = Core()->getAllSearch(search_for, searchspace);
+    search.clear();
     search_model->endResetModel();
+    continueButton->hide();
+    resumeAddress = RVA_INVALID;
+    resultsKey.clear();
+    refineBase.clear();
+}
 
+void SearchWidget::cacheResults()
+{
+    if (pendingKey.isEmpty()) {
+        return;
+    }
+    searchCache.insert(pendingKey, new CachedSearch { search, searchRanges, refineBase, resumeAddress },
+                       qMax(1, search.size()));
+    resultsKey = pendingKey;
+    pendingKey.clear();
+}
+
+bool SearchWidget::restoreCachedSearch(const QString &key)
+{
+    const CachedSearch *cached = searchCache.object(key);
+    if (!cached) {
+        return false;
+    }
+    search_model->beginResetModel();
+    search = cached->hits;
+    search_model->endResetModel();
+    searchRanges = cached->ranges;
+    refineBase = cached->refineBase;
+    resumeAddress = cached->resumeAddress;
+    continueButton->setVisible(resumeAddress != RVA_INVALID);
+    resultsKey = key;
+    qhelpers::adjustColumns(ui->searchTreeView, 3, 0);
+    updateItemsNumber();
+    return true;
+}
+
+bool SearchWidget::parsePatterns(const QString &space, const QString &text,
+                                 QList<PatternMatcher::Pattern> *patterns)
+{
+    QString error;
+    bool ok = true;
+    if (space == kPatternSearchSpace && text.isEmpty()) {
+        *patterns = loadedPatterns;
+    } else if (space == kPatternSearchSpace) {
+        // Patterns typed in are separated by ;
+        ok = PatternMatcher::parsePatternList(QString(text).replace(';', '\n'), patterns, &error);
+    } else if (space == "/xj") {
+        PatternMatcher::Pattern pattern;
+        ok = PatternMatcher::parsePattern(text, &pattern, &error);
+        pattern.name = text;
+        patterns->append(pattern);
+    } else if (space == "/vj") {
+        // The value as it is stored in memory
+        quint32 value = static_cast<quint32>(Core()->math(text));
+        QByteArray bytes(4, 0);
+        bool bigEndian = Core()->getConfigb("cfg.bigendian");
+        for (int i = 0; i < 4; i++) {
+            bytes[bigEndian ? 3 - i : i] = static_cast<char>(value >> (8 * i));
+        }
+        patterns->append(PatternMatcher::Pattern { text, bytes, QByteArray(4, '\xff') });
+    } else {
+        QByteArray bytes = text.toUtf8();
+        patterns->append(PatternMatcher::Pattern { text, bytes, QByteArray(bytes.size(), '\xff') });
+    }
+    if (!ok) {
+        patterns->clear();
+        QMessageBox::warning(this, tr("Invalid pattern"), error);
+    }
+    return ok;
+}
+
+void SearchWidget::loadPatterns()
+{
+    QString filename = QFileDialog::getOpenFileName(this, tr("Select pattern file"),
+                                                    Config()->getRecentFolder(),
+                                                    tr("Pattern files (*.txt *.pat);;All files (*)"));
+    if (filename.isEmpty()) {
+        return;
+    }
+    Config()->setRecentFolder(QFileInfo(filename).absolutePath());
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        QMessageBox::critical(this, tr("Error"), file.errorString());
+        return;
+    }
+    QList<PatternMatcher::Pattern> patterns;
+    QString error;
+    if (!PatternMatcher::parsePatternList(QString::fromUtf8(file.readAll()), &patterns, &error)) {
+        QMessageBox::critical(this, tr("Error"), error);
+        return;
+    }
+    loadedPatterns = patterns;
+    loadedPatternsSerial++;
+    ui->filterLineEdit->clear();
+    updatePlaceholderText(ui->searchspaceCombo->currentIndex());
+    refreshSearch();
+}
+
+void SearchWidget::hitsFound(const QList<SearchDescription> &hits)
+{
+    if (sender() != task.data() || hits.isEmpty()) {
+        return;
+    }
+    bool first = search.isEmpty();
+    int row = search.size();
+    search_model->beginInsertRows(QModelIndex(), row, row + hits.size() - 1);
+    search.append(hits);
+    search_model->endInsertRows();
+
+    if (first) {
+        qhelpers::adjustColumns(ui->searchTreeView, 3, 0);
+    }
+    updateItemsNumber();
+}
+
+void SearchWidget::searchFinished()
+{
+    if (sender() != task.data()) {
+        return;
+    }
+    task.clear();
+    cacheResults();
+    ui->searchButton->setText(tr("Search"));
     qhelpers::adjustColumns(ui->searchTreeView, 3, 0);
+    updateItemsNumber();
+}
+
+void SearchWidget::updateItemsNumber()
+{
+    if (task && task->getProgressTotal() > 0) {
+        tree->showItemsNumber(search.size(),
+                              static_cast<int>(task->getProgressDone() * 100 / task->getProgressTotal()));
+    } else {
+        tree->showItemsNumber(search.size());
+    }
 }
 
 void SearchWidget::setScrollMode()
@@ -253,6 +568,7 @@ void SearchWidget::setScrollMode()
 
 void SearchWidget::updatePlaceholderText(int index)
 {
+    loadPatternsButton->setVisible(index == 5);
     switch (index) {
     case 1: // string
         ui->filterLineEdit->setPlaceholderText("foobar");
@@ -266,6 +582,14 @@ void SearchWidget::updatePlaceholderText(int index)
     case 4: // 32bit value
         ui->filterLineEdit->setPlaceholderText("0xdeadbeef");
         break;
+    case 5: // byte patterns
+        if (loadedPatterns.isEmpty()) {
+            ui->filterLineEdit->setPlaceholderText("4d5a??00;e8 ?? ?? ?? ?? 5?");
+        } else {
+            ui->filterLineEdit->setPlaceholderText(tr("%n pattern(s) loaded from file", nullptr,
+                                                      loadedPatterns.size()));
+        }
+        break;
     default:
         ui->filterLineEdit->setPlaceholderText("jmp rax");
     }
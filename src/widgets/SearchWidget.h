@@ -4,12 +4,18 @@
 #include <memory>
 
 #include <QAbstractItemModel>
+#include <QCache>
 #include <QSortFilterProxyModel>
 
 #include "core/Cutter.h"
 #include "CutterDockWidget.h"
+#include "CutterTreeWidget.h"
+#include "common/PatternMatcher.h"
+#include "common/SearchTask.h"
 
 class MainWindow;
+class QCheckBox;
+class QPushButton;
 class QTreeWidgetItem;
 class SearchWidget;
 
@@ -69,6 +75,8 @@ private slots:
     void on_searchInCombo_currentIndexChanged(int index);
     void searchChanged();
     void refreshSearchspaces();
+    void hitsFound(const QList<SearchDescription> &hits);
+    void searchFinished();
 
 private:
     std::unique_ptr<Ui::SearchWidget> ui;
@@ -76,8 +84,54 @@ private:
     SearchModel *search_model;
     SearchSortFilterProxyModel *search_proxy_model;
     QList<SearchDescription> search;
+    CutterTreeWidget *tree;
+    QPushButton *continueButton;
+    QPushButton *loadPatternsButton;
+    QCheckBox *refineCheckBox;
+
+    QSharedPointer<SearchTask> task;
+    QString searchFor;
+    QString searchSpace;
+    QList<SearchTask::Range> searchRanges;
+    RVA resumeAddress = RVA_INVALID;
+    QList<PatternMatcher::Pattern> searchPatterns;
+    QList<PatternMatcher::Pattern> loadedPatterns;
+    int loadedPatternsSerial = 0;
+
+    /**
+     * Everything needed to show the hits of a search again and to continue it
+     */
+    struct CachedSearch {
+        QList<SearchDescription> hits;
+        QList<SearchTask::Range> ranges;
+        QList<SearchDescription> refineBase;
+        RVA resumeAddress;
+    };
+    QCache<QString, CachedSearch> searchCache;
+    /**
+     * Incremented whenever memory may have changed, it is part of every cache key
+     */
+    int searchEpoch = 0;
+    /**
+     * Cache key of the running search and of the hits shown once it is complete
+     */
+    QString pendingKey;
+    QString resultsKey;
+    /**
+     * Hits of the search being refined, empty for a search over the ranges
+     */
+    QList<SearchDescription> refineBase;
 
     void refreshSearch();
+    void startSearch(const QList<SearchTask::Range> &ranges);
+    void stopSearch();
+    void clearResults();
+    void cacheResults();
+    bool restoreCachedSearch(const QString &key);
+    bool parsePatterns(const QString &space, const QString &text,
+                       QList<PatternMatcher::Pattern> *patterns);
+    void loadPatterns();
+    void updateItemsNumber();
     void setScrollMode();
     void updatePlaceholderText(int index);
 };
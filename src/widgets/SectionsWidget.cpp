@@ -4,6 +4,8 @@
 #include "core/MainWindow.h"
 #include "common/Helpers.h"
 #include "common/Configuration.h"
+#include "common/EntropyMapProvider.h"
+#include "common/SectionEntropyProvider.h"
 
 #include <QGraphicsSceneMouseEvent>
 #include <QGraphicsTextItem>
@@ -240,6 +242,12 @@ void SectionsWidget::initConnects()
     });
     connect(Core(), SIGNAL(seekChanged(RVA)), this, SLOT(onSectionsSeekChanged(RVA)));
     connect(Config(), SIGNAL(colorsUpdated()), this, SLOT(refreshSections()));
+    connect(Core()->getEntropyMapProvider(), &EntropyMapProvider::mapChanged, this, [this]() {
+        virtualAddrDock->updateDock();
+        drawIndicatorOnAddrDocks();
+    });
+    connect(Core()->getSectionEntropyProvider(), &SectionEntropyProvider::entropyChanged,
+            this, &SectionsWidget::updateEntropy);
     connect(toggleButton, &QToolButton::clicked, this, [ = ] {
         toggleButton->hide();
         addrDockWidget->show();
@@ -257,12 +265,29 @@ void SectionsWidget::refreshSections()
     sectionsModel->beginResetModel();
     sections = Core()->getAllSections();
     sectionsModel->endResetModel();
+    // The entropy column is filled in once the entropy is known, the virtual map shows the
+    // entropy strips only while the navigation bar has the entropy computed for its heatmap
+    Core()->getSectionEntropyProvider()->request(sections);
     qhelpers::adjustColumns(sectionsTable, SectionsModel::ColumnCount, 0);
     rawAddrDock->updateDock();
     virtualAddrDock->updateDock();
     drawIndicatorOnAddrDocks();
 }
 
+void SectionsWidget::updateEntropy()
+{
+    if (sections.isEmpty()) {
+        return;
+    }
+    SectionEntropyProvider *provider = Core()->getSectionEntropyProvider();
+    for (SectionDescription &section : sections) {
+        section.entropy = provider->getEntropy(section.paddr, section.size);
+    }
+    emit sectionsModel->dataChanged(sectionsModel->index(0, SectionsModel::EntropyColumn),
+                                    sectionsModel->index(sections.count() - 1,
+                                                         SectionsModel::EntropyColumn));
+}
+
 void SectionsWidget::onSectionsDoubleClicked(const QModelIndex &index)
 {
     if (!index.isValid()) {
@@ -532,11 +557,13 @@ void VirtualAddrDock::updateDock()
         addrDockScene->nameAddrMap[name] = addr;
         addrDockScene->nameAddrSizeMap[name] = size;
 
+        RVA vsize = static_cast<RVA>(qMax(size, 0));
         size = getAdjustedSize(size, validMinSize);
 
         QGraphicsRectItem *rect = new QGraphicsRectItem(rectOffset, y, rectWidth, size);
         rect->setBrush(QBrush(idx.data(Qt::DecorationRole).value<QColor>()));
         addrDockScene->addItem(rect);
+        drawEntropy(addr, vsize, y, size);
 
         addTextItem(textColor, QPoint(0, y), QString("0x%1").arg(addr, 0, 16));
         addTextItem(textColor, QPoint(rectOffset, y), QString::number(size));
@@ -549,6 +576,32 @@ void VirtualAddrDock::updateDock()
     }
 }
 
+void VirtualAddrDock::drawEntropy(RVA addr, RVA size, int y, int height)
+{
+    const EntropyMap &entropy = Core()->getEntropyMapProvider()->getMap();
+    if (entropy.isEmpty() || !size || height <= 0) {
+        return;
+    }
+    const int stripWidth = 20;
+    const int maxSlices = 64;
+    int slices = qMin(height, maxSlices);
+    for (int i = 0; i < slices; i++) {
+        RVA sliceStart = addr + size * i / slices;
+        RVA sliceEnd = addr + size * (i + 1) / slices;
+        if (sliceEnd <= entropy.from || sliceStart >= entropy.to) {
+            continue;
+        }
+        int sliceY = y + height * i / slices;
+        int sliceHeight = y + height * (i + 1) / slices - sliceY;
+        EntropyBucket bucket = entropy.average(sliceStart, qMax(sliceEnd, sliceStart + 1));
+        QGraphicsRectItem *slice = new QGraphicsRectItem(rectOffset + rectWidth - stripWidth, sliceY,
+                                                         stripWidth, sliceHeight);
+        slice->setPen(Qt::NoPen);
+        slice->setBrush(QBrush(EntropyMap::entropyColor(bucket.entropy)));
+        addrDockScene->addItem(slice);
+    }
+}
+
 int VirtualAddrDock::getValidMinSize()
 {
     proxyModel->sort(1, Qt::AscendingOrder);
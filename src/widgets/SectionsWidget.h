@@ -72,6 +72,7 @@ private slots:
     void refreshSections();
     void onSectionsDoubleClicked(const QModelIndex &index);
     void onSectionsSeekChanged(RVA addr);
+    void updateEntropy();
 
 private:
     QList<SectionDescription> sections;
@@ -177,6 +178,9 @@ public:
 
     void updateDock() override;
     int getValidMinSize();
+
+private:
+    void drawEntropy(RVA addr, RVA size, int y, int height);
 };
 
 #endif // SECTIONSWIDGET_H
@@ -3,6 +3,7 @@
 #include "core/MainWindow.h"
 #include "QuickFilterView.h"
 #include "common/Helpers.h"
+#include "common/RefreshScheduler.h"
 
 #include <QVBoxLayout>
 #include <QShortcut>
@@ -175,11 +176,15 @@ SegmentsWidget::~SegmentsWidget() {}
 
 void SegmentsWidget::refreshSegments()
 {
-    segmentsModel->beginResetModel();
-    segments = Core()->getAllSegments();
-    segmentsModel->endResetModel();
-
-    qhelpers::adjustColumns(segmentsTable, SegmentsModel::ColumnCount, 0);
+    Core()->getRefreshScheduler()->schedule<QList<SegmentDescription>>(this, []() {
+        return Core()->getAllSegments();
+    }, [this](const QList<SegmentDescription> &segments) {
+        segmentsModel->beginResetModel();
+        this->segments = segments;
+        segmentsModel->endResetModel();
+
+        qhelpers::adjustColumns(segmentsTable, SegmentsModel::ColumnCount, 0);
+    });
 }
 
 void SegmentsWidget::onSegmentsDoubleClicked(const QModelIndex &index)
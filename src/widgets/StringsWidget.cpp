@@ -3,6 +3,7 @@
 #include "core/MainWindow.h"
 #include "common/Helpers.h"
 #include "dialogs/XrefsDialog.h"
+#include "dialogs/AsyncTaskDialog.h"
 #include "WidgetShortcuts.h"
 
 #include <QClipboard>
@@ -10,7 +11,7 @@
 #include <QModelIndex>
 #include <QShortcut>
 
-StringsModel::StringsModel(QList<StringDescription> *strings, QObject *parent)
+StringsModel::StringsModel(StringTable *strings, QObject *parent)
     : QAbstractListModel(parent),
       strings(strings)
 {
@@ -18,7 +19,7 @@ StringsModel::StringsModel(QList<StringDescription> *strings, QObject *parent)
 
 int StringsModel::rowCount(const QModelIndex &) const
 {
-    return strings->count();
+    return strings->size();
 }
 
 int StringsModel::columnCount(const QModelIndex &) const
@@ -28,31 +29,32 @@ int StringsModel::columnCount(const QModelIndex &) const
 
 QVariant StringsModel::data(const QModelIndex &index, int role) const
 {
-    if (index.row() >= strings->count())
+    if (index.row() >= strings->size())
         return QVariant();
 
-    const StringDescription &str = strings->at(index.row());
+    StringTable::Row str = strings->at(index.row());
 
     switch (role) {
     case Qt::DisplayRole:
         switch (index.column()) {
         case StringsModel::OffsetColumn:
-            return RAddressString(str.vaddr);
+            // Found outside of the mapped sections
+            return str.vaddr() == RVA_INVALID ? QString() : RAddressString(str.vaddr());
         case StringsModel::StringColumn:
-            return str.string;
+            return str.string();
         case StringsModel::TypeColumn:
-            return str.type.toUpper();
+            return str.type().toUpper();
         case StringsModel::LengthColumn:
-            return str.length;
+            return str.length();
         case StringsModel::SizeColumn:
-            return str.size;
+            return str.size();
         case StringsModel::SectionColumn:
-            return str.section;
+            return str.section();
         default:
             return QVariant();
         }
     case StringDescriptionRole:
-        return QVariant::fromValue(str);
+        return QVariant::fromValue(str.toDescription());
     default:
         return QVariant();
     }
@@ -84,47 +86,75 @@ QVariant StringsModel::headerData(int section, Qt::Orientation, int role) const
 }
 
 StringsProxyModel::StringsProxyModel(StringsModel *sourceModel, QObject *parent)
-    : QSortFilterProxyModel(parent)
+    : AsyncSortFilterProxyModel(parent)
 {
     setSourceModel(sourceModel);
     setFilterCaseSensitivity(Qt::CaseInsensitive);
-    setSortCaseSensitivity(Qt::CaseInsensitive);
 }
 
-bool StringsProxyModel::filterAcceptsRow(int row, const QModelIndex &parent) const
-{
-    QModelIndex index = sourceModel()->index(row, 0, parent);
-    StringDescription str = index.data(StringsModel::StringDescriptionRole).value<StringDescription>();
-    if (selectedSection.isEmpty())
-        return str.string.contains(filterRegExp());
-    else
-        return selectedSection == str.section && str.string.contains(filterRegExp());
-}
+namespace {
 
-bool StringsProxyModel::lessThan(const QModelIndex &left, const QModelIndex &right) const
+class StringsSnapshot : public AsyncSortFilterProxyModel::Snapshot
 {
-    auto leftStr = left.data(StringsModel::StringDescriptionRole).value<StringDescription>();
-    auto rightStr = right.data(StringsModel::StringDescriptionRole).value<StringDescription>();
-
-    switch (left.column()) {
-    case StringsModel::OffsetColumn:
-        return leftStr.vaddr < rightStr.vaddr;
-    case StringsModel::StringColumn: // sort by string
-        return leftStr.string < rightStr.string;
-    case StringsModel::TypeColumn: // sort by type
-        return leftStr.type < rightStr.type;
-    case StringsModel::SizeColumn: // sort by size
-        return leftStr.size < rightStr.size;
-    case StringsModel::LengthColumn: // sort by length
-        return leftStr.length < rightStr.length;
-    case StringsModel::SectionColumn:
-        return leftStr.section < rightStr.section;
-    default:
-        break;
+public:
+    StringsSnapshot(const StringTable &strings, const QString &selectedSection)
+        : strings(strings),
+          selectedSection(selectedSection)
+    {
     }
 
-    // fallback
-    return leftStr.vaddr < rightStr.vaddr;
+    QString filterText(int row) const override
+    {
+        return strings.at(row).string();
+    }
+
+    bool filterAcceptsRow(int row, const QRegExp &filter) const override
+    {
+        StringTable::Row str = strings.at(row);
+        if (selectedSection.isEmpty())
+            return str.string().contains(filter);
+        else
+            return selectedSection == str.section() && str.string().contains(filter);
+    }
+
+    bool lessThan(int left, int right, int column) const override
+    {
+        StringTable::Row leftStr = strings.at(left);
+        StringTable::Row rightStr = strings.at(right);
+
+        switch (column) {
+        case StringsModel::OffsetColumn:
+            return leftStr.vaddr() < rightStr.vaddr();
+        case StringsModel::StringColumn: // sort by string
+            return strings.compareStrings(left, right, Qt::CaseInsensitive) < 0;
+        case StringsModel::TypeColumn: // sort by type
+            return leftStr.type() < rightStr.type();
+        case StringsModel::SizeColumn: // sort by size
+            return leftStr.size() < rightStr.size();
+        case StringsModel::LengthColumn: // sort by length
+            return leftStr.length() < rightStr.length();
+        case StringsModel::SectionColumn:
+            return QString::compare(leftStr.section(), rightStr.section(), Qt::CaseInsensitive) < 0;
+        default:
+            break;
+        }
+
+        // fallback
+        return leftStr.vaddr() < rightStr.vaddr();
+    }
+
+private:
+    // Implicitly shared with the model, so this is only a copy if the model changes meanwhile
+    StringTable strings;
+    QString selectedSection;
+};
+
+}
+
+AsyncSortFilterProxyModel::Snapshot *StringsProxyModel::createSnapshot() const
+{
+    auto model = static_cast<StringsModel *>(sourceModel());
+    return new StringsSnapshot(*model->strings, selectedSection);
 }
 
 
@@ -171,10 +201,21 @@ StringsWidget::StringsWidget(MainWindow *main, QAction *action) :
     connect(ui->quickFilterView, SIGNAL(filterTextChanged(const QString &)), proxyModel,
             SLOT(setFilterWildcard(const QString &)));
 
-    connect(ui->quickFilterView, &ComboQuickFilterView::filterTextChanged, this, [this] {
-        tree->showItemsNumber(proxyModel->rowCount());
+    // Filtering and sorting finish in the background
+    connect(proxyModel, &AsyncSortFilterProxyModel::sortFilterFinished, this, [this] {
+        if (columnsAdjustPending) {
+            columnsAdjustPending = false;
+            qhelpers::adjustColumns(ui->stringsTreeView, 5, 0);
+            if (ui->stringsTreeView->columnWidth(1) > 300)
+                ui->stringsTreeView->setColumnWidth(1, 300);
+        }
+        updateItemsNumber();
     });
 
+    searchProgressAction = new QAction(tr("Show Search Progress"), this);
+    searchProgressAction->setEnabled(false);
+    connect(searchProgressAction, &QAction::triggered, this, &StringsWidget::showSearchProgress);
+
     QShortcut *searchShortcut = new QShortcut(QKeySequence::Find, this);
     connect(searchShortcut, &QShortcut::activated, ui->quickFilterView, &ComboQuickFilterView::showFilter);
     searchShortcut->setContext(Qt::WidgetWithChildrenShortcut);
@@ -189,8 +230,7 @@ StringsWidget::StringsWidget(MainWindow *main, QAction *action) :
         ui->quickFilterView->comboBox(), &QComboBox::currentTextChanged, this,
         [this]() {
             proxyModel->selectedSection = ui->quickFilterView->comboBox()->currentData().toString();
-            proxyModel->setFilterRegExp(proxyModel->filterRegExp());
-            tree->showItemsNumber(proxyModel->rowCount());
+            proxyModel->invalidate();
         }
     );
 }
@@ -204,18 +244,32 @@ void StringsWidget::on_stringsTreeView_doubleClicked(const QModelIndex &index)
     }
 
     StringDescription str = index.data(StringsModel::StringDescriptionRole).value<StringDescription>();
+    if (str.vaddr == RVA_INVALID) {
+        return;
+    }
     Core()->seek(str.vaddr);
 }
 
 void StringsWidget::refreshStrings()
 {
     if (task) {
-        task->wait();
+        // Batches it already queued are dropped in stringsFound
+        task->interrupt();
     }
 
-    task = QSharedPointer<StringsTask>(new StringsTask());
-    connect(task.data(), &StringsTask::stringSearchFinished, this,
-            &StringsWidget::stringSearchFinished);
+    model->beginResetModel();
+    strings.clear();
+    model->endResetModel();
+    columnsAdjustPending = true;
+
+    // Same minimum length as izz, which uses 4 if it is not set
+    int minLength = Core()->getConfigi("bin.minstr");
+    StringScanner scanner(minLength > 0 ? minLength : 4);
+    task = QSharedPointer<StringsTask>(new StringsTask(scanner));
+    task->setSupersedeKey(this, QStringLiteral("strings"));
+    connect(task.data(), &StringsTask::stringsFound, this, &StringsWidget::stringsFound);
+    connect(task.data(), &AsyncTask::finished, this, &StringsWidget::stringSearchFinished);
+    searchProgressAction->setEnabled(true);
     Core()->getAsyncTaskManager()->start(task);
 
     refreshSectionCombo();
@@ -235,19 +289,49 @@ void StringsWidget::refreshSectionCombo()
     proxyModel->selectedSection.clear();
 }
 
-void StringsWidget::stringSearchFinished(const QList<StringDescription> &strings)
+void StringsWidget::stringsFound(const StringTable &strings)
 {
-    model->beginResetModel();
-    this->strings = strings;
-    model->endResetModel();
-
-    qhelpers::adjustColumns(ui->stringsTreeView, 5, 0);
-    if (ui->stringsTreeView->columnWidth(1) > 300)
-        ui->stringsTreeView->setColumnWidth(1, 300);
+    if (sender() != task.data()) {
+        return;
+    }
 
-    tree->showItemsNumber(proxyModel->rowCount());
+    // Appending lets the proxy extend its index and keep the current selection
+    int first = this->strings.size();
+    model->beginInsertRows(QModelIndex(), first, first + strings.size() - 1);
+    this->strings.append(strings);
+    model->endInsertRows();
+}
 
+void StringsWidget::stringSearchFinished()
+{
+    if (sender() != task.data()) {
+        return;
+    }
     task = nullptr;
+    searchProgressAction->setEnabled(false);
+    updateItemsNumber();
+}
+
+void StringsWidget::showSearchProgress()
+{
+    if (!task) {
+        return;
+    }
+    AsyncTaskDialog *taskDialog = new AsyncTaskDialog(task, this);
+    // Closing the dialog cancels the search, the strings found so far stay
+    taskDialog->setInterruptOnClose(true);
+    taskDialog->setAttribute(Qt::WA_DeleteOnClose);
+    taskDialog->show();
+}
+
+void StringsWidget::updateItemsNumber()
+{
+    if (task && task->getProgressTotal() > 0) {
+        tree->showItemsNumber(proxyModel->rowCount(),
+                              static_cast<int>(task->getProgressDone() * 100 / task->getProgressTotal()));
+    } else {
+        tree->showItemsNumber(proxyModel->rowCount());
+    }
 }
 
 void StringsWidget::showStringsContextMenu(const QPoint &pt)
@@ -260,6 +344,8 @@ void StringsWidget::showStringsContextMenu(const QPoint &pt)
     menu->addAction(ui->actionFilter);
     menu->addSeparator();
     menu->addAction(ui->actionX_refs);
+    menu->addSeparator();
+    menu->addAction(searchProgressAction);
 
     menu->exec(ui->stringsTreeView->mapToGlobal(pt));
 
@@ -270,6 +356,9 @@ void StringsWidget::on_actionX_refs_triggered()
 {
     StringDescription str = ui->stringsTreeView->selectionModel()->currentIndex().data(
                                 StringsModel::StringDescriptionRole).value<StringDescription>();
+    if (str.vaddr == RVA_INVALID) {
+        return;
+    }
 
     XrefsDialog x(nullptr);
     x.fillRefsForAddress(str.vaddr, RAddressString(str.vaddr), false);
@@ -7,9 +7,9 @@
 #include "CutterDockWidget.h"
 #include "common/StringsTask.h"
 #include "CutterTreeWidget.h"
+#include "common/AsyncSortFilterProxyModel.h"
 
 #include <QAbstractListModel>
-#include <QSortFilterProxyModel>
 
 class MainWindow;
 class QTreeWidgetItem;
@@ -26,13 +26,13 @@ class StringsModel: public QAbstractListModel
     friend StringsWidget;
 
 private:
-    QList<StringDescription> *strings;
+    StringTable *strings;
 
 public:
     enum Column { OffsetColumn = 0, StringColumn, TypeColumn, LengthColumn, SizeColumn, SectionColumn, ColumnCount };
     static const int StringDescriptionRole = Qt::UserRole;
 
-    StringsModel(QList<StringDescription> *strings, QObject *parent = nullptr);
+    StringsModel(StringTable *strings, QObject *parent = nullptr);
 
     int rowCount(const QModelIndex &parent = QModelIndex()) const;
     int columnCount(const QModelIndex &parent = QModelIndex()) const;
@@ -43,7 +43,7 @@ public:
 
 
 
-class StringsProxyModel : public QSortFilterProxyModel
+class StringsProxyModel : public AsyncSortFilterProxyModel
 {
     Q_OBJECT
 
@@ -53,8 +53,7 @@ public:
     StringsProxyModel(StringsModel *sourceModel, QObject *parent = nullptr);
 
 protected:
-    bool filterAcceptsRow(int row, const QModelIndex &parent) const override;
-    bool lessThan(const QModelIndex &left, const QModelIndex &right) const override;
+    Snapshot *createSnapshot() const override;
 
     QString selectedSection;
 };
@@ -72,7 +71,9 @@ private slots:
     void on_stringsTreeView_doubleClicked(const QModelIndex &index);
 
     void refreshStrings();
-    void stringSearchFinished(const QList<StringDescription> &strings);
+    void stringsFound(const StringTable &strings);
+    void stringSearchFinished();
+    void showSearchProgress();
     void refreshSectionCombo();
 
     void showStringsContextMenu(const QPoint &pt);
@@ -86,8 +87,12 @@ private:
 
     StringsModel *model;
     StringsProxyModel *proxyModel;
-    QList<StringDescription> strings;
+    StringTable strings;
     CutterTreeWidget *tree;
+    bool columnsAdjustPending = false;
+    QAction *searchProgressAction;
+
+    void updateItemsNumber();
 };
 
 #endif // STRINGSWIDGET_H
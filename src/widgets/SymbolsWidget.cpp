@@ -2,10 +2,11 @@
 #include "ui_SymbolsWidget.h"
 #include "core/MainWindow.h"
 #include "common/Helpers.h"
+#include "common/RefreshScheduler.h"
 
 #include <QShortcut>
 
-SymbolsModel::SymbolsModel(QList<SymbolDescription> *symbols, QObject *parent)
+SymbolsModel::SymbolsModel(SymbolTable *symbols, QObject *parent)
     : QAbstractListModel(parent),
       symbols(symbols)
 {
@@ -13,7 +14,7 @@ SymbolsModel::SymbolsModel(QList<SymbolDescription> *symbols, QObject *parent)
 
 int SymbolsModel::rowCount(const QModelIndex &) const
 {
-    return symbols->count();
+    return symbols->size();
 }
 
 int SymbolsModel::columnCount(const QModelIndex &) const
@@ -23,26 +24,26 @@ int SymbolsModel::columnCount(const QModelIndex &) const
 
 QVariant SymbolsModel::data(const QModelIndex &index, int role) const
 {
-    if (index.row() >= symbols->count()) {
+    if (index.row() >= symbols->size()) {
         return QVariant();
     }
 
-    const SymbolDescription &symbol = symbols->at(index.row());
+    SymbolTable::Row symbol = symbols->at(index.row());
 
     switch (role) {
     case Qt::DisplayRole:
         switch (index.column()) {
         case SymbolsModel::AddressColumn:
-            return RAddressString(symbol.vaddr);
+            return RAddressString(symbol.vaddr());
         case SymbolsModel::TypeColumn:
-            return QString("%1 %2").arg(symbol.bind, symbol.type).trimmed();
+            return QString("%1 %2").arg(symbol.bind(), symbol.type()).trimmed();
         case SymbolsModel::NameColumn:
-            return symbol.name;
+            return symbol.name();
         default:
             return QVariant();
         }
     case SymbolsModel::SymbolDescriptionRole:
-        return QVariant::fromValue(symbol);
+        return QVariant::fromValue(symbol.toDescription());
     default:
         return QVariant();
     }
@@ -68,38 +69,55 @@ QVariant SymbolsModel::headerData(int section, Qt::Orientation, int role) const
 }
 
 SymbolsProxyModel::SymbolsProxyModel(SymbolsModel *sourceModel, QObject *parent)
-    : QSortFilterProxyModel(parent)
+    : AsyncSortFilterProxyModel(parent)
 {
     setSourceModel(sourceModel);
     setFilterCaseSensitivity(Qt::CaseInsensitive);
-    setSortCaseSensitivity(Qt::CaseInsensitive);
 }
 
-bool SymbolsProxyModel::filterAcceptsRow(int row, const QModelIndex &parent) const
+namespace {
+
+class SymbolsSnapshot : public AsyncSortFilterProxyModel::Snapshot
 {
-    QModelIndex index = sourceModel()->index(row, 0, parent);
-    auto symbol = index.data(SymbolsModel::SymbolDescriptionRole).value<SymbolDescription>();
+public:
+    explicit SymbolsSnapshot(const SymbolTable &symbols)
+        : symbols(symbols)
+    {
+    }
 
-    return symbol.name.contains(filterRegExp());
-}
+    QString filterText(int row) const override
+    {
+        return symbols.at(row).name();
+    }
 
-bool SymbolsProxyModel::lessThan(const QModelIndex &left, const QModelIndex &right) const
-{
-    auto leftSymbol = left.data(SymbolsModel::SymbolDescriptionRole).value<SymbolDescription>();
-    auto rightSymbol = right.data(SymbolsModel::SymbolDescriptionRole).value<SymbolDescription>();
-
-    switch (left.column()) {
-    case SymbolsModel::AddressColumn:
-        return leftSymbol.vaddr < rightSymbol.vaddr;
-    case SymbolsModel::TypeColumn:
-        return leftSymbol.type < rightSymbol.type;
-    case SymbolsModel::NameColumn:
-        return leftSymbol.name < rightSymbol.name;
-    default:
-        break;
+    bool lessThan(int left, int right, int column) const override
+    {
+        SymbolTable::Row leftSymbol = symbols.at(left);
+        SymbolTable::Row rightSymbol = symbols.at(right);
+
+        switch (column) {
+        case SymbolsModel::AddressColumn:
+            return leftSymbol.vaddr() < rightSymbol.vaddr();
+        case SymbolsModel::TypeColumn:
+            return leftSymbol.type() < rightSymbol.type();
+        case SymbolsModel::NameColumn:
+            return symbols.compareNames(left, right, Qt::CaseInsensitive) < 0;
+        default:
+            break;
+        }
+
+        return false;
     }
 
-    return false;
+private:
+    SymbolTable symbols;
+};
+
+}
+
+AsyncSortFilterProxyModel::Snapshot *SymbolsProxyModel::createSnapshot() const
+{
+    return new SymbolsSnapshot(*static_cast<SymbolsModel *>(sourceModel())->symbols);
 }
 
 SymbolsWidget::SymbolsWidget(MainWindow *main, QAction *action) :
@@ -131,7 +149,11 @@ SymbolsWidget::SymbolsWidget(MainWindow *main, QAction *action) :
             symbolsProxyModel, SLOT(setFilterWildcard(const QString &)));
     connect(ui->quickFilterView, SIGNAL(filterClosed()), ui->symbolsTreeView, SLOT(setFocus()));
 
-    connect(ui->quickFilterView, &QuickFilterView::filterTextChanged, this, [this] {
+    connect(symbolsProxyModel, &AsyncSortFilterProxyModel::sortFilterFinished, this, [this] {
+        if (columnsAdjustPending) {
+            columnsAdjustPending = false;
+            qhelpers::adjustColumns(ui->symbolsTreeView, SymbolsModel::ColumnCount, 0);
+        }
         tree->showItemsNumber(symbolsProxyModel->rowCount());
     });
     
@@ -155,13 +177,17 @@ void SymbolsWidget::on_symbolsTreeView_doubleClicked(const QModelIndex &index)
 
 void SymbolsWidget::refreshSymbols()
 {
-    symbolsModel->beginResetModel();
-    symbols = Core()->getAllSymbols();
-    symbolsModel->endResetModel();
-
-    qhelpers::adjustColumns(ui->symbolsTreeView, SymbolsModel::ColumnCount, 0);
-
-    tree->showItemsNumber(symbolsProxyModel->rowCount());
+    // The table is built in the background as well
+    Core()->getRefreshScheduler()->schedule<SymbolTable>(this, []() {
+        return SymbolTable(Core()->getAllSymbols());
+    }, [this](const SymbolTable &symbols) {
+        symbolsModel->beginResetModel();
+        this->symbols = symbols;
+        symbolsModel->endResetModel();
+
+        // Rows only show up in the view once they are sorted
+        columnsAdjustPending = true;
+    });
 }
 
 void SymbolsWidget::setScrollMode()
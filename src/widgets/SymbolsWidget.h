@@ -3,15 +3,17 @@
 
 #include <memory>
 #include <QAbstractListModel>
-#include <QSortFilterProxyModel>
 
 #include "core/Cutter.h"
 #include "CutterDockWidget.h"
 #include "CutterTreeWidget.h"
+#include "common/AsyncSortFilterProxyModel.h"
+#include "common/CompactTables.h"
 
 class MainWindow;
 class QTreeWidgetItem;
 class SymbolsWidget;
+class SymbolsProxyModel;
 
 namespace Ui {
 class SymbolsWidget;
@@ -22,15 +24,16 @@ class SymbolsModel: public QAbstractListModel
     Q_OBJECT
 
     friend SymbolsWidget;
+    friend SymbolsProxyModel;
 
 private:
-    QList<SymbolDescription> *symbols;
+    SymbolTable *symbols;
 
 public:
     enum Column { AddressColumn = 0, TypeColumn, NameColumn, ColumnCount };
     enum Role { SymbolDescriptionRole = Qt::UserRole };
 
-    SymbolsModel(QList<SymbolDescription> *exports, QObject *parent = nullptr);
+    SymbolsModel(SymbolTable *symbols, QObject *parent = nullptr);
 
     int rowCount(const QModelIndex &parent = QModelIndex()) const;
     int columnCount(const QModelIndex &parent = QModelIndex()) const;
@@ -39,7 +42,7 @@ public:
     QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
 };
 
-class SymbolsProxyModel : public QSortFilterProxyModel
+class SymbolsProxyModel : public AsyncSortFilterProxyModel
 {
     Q_OBJECT
 
@@ -47,8 +50,7 @@ public:
     SymbolsProxyModel(SymbolsModel *sourceModel, QObject *parent = nullptr);
 
 protected:
-    bool filterAcceptsRow(int row, const QModelIndex &parent) const override;
-    bool lessThan(const QModelIndex &left, const QModelIndex &right) const override;
+    Snapshot *createSnapshot() const override;
 };
 
 
@@ -68,10 +70,11 @@ private slots:
 private:
     std::unique_ptr<Ui::SymbolsWidget> ui;
 
-    QList<SymbolDescription> symbols;
+    SymbolTable symbols;
     SymbolsModel *symbolsModel;
     SymbolsProxyModel *symbolsProxyModel;
     CutterTreeWidget *tree;
+    bool columnsAdjustPending = false;
 
     void setScrollMode();
 };
@@ -6,6 +6,7 @@
 
 #include "VTablesWidget.h"
 #include "ui_VTablesWidget.h"
+#include "common/RefreshScheduler.h"
 
 VTableModel::VTableModel(QList<VTableDescription> *vtables, QObject *parent)
     : QAbstractItemModel(parent),
@@ -169,15 +170,19 @@ VTablesWidget::~VTablesWidget()
 
 void VTablesWidget::refreshVTables()
 {
-    model->beginResetModel();
-    vtables = Core()->getAllVTables();
-    model->endResetModel();
+    Core()->getRefreshScheduler()->schedule<QList<VTableDescription>>(this, []() {
+        return Core()->getAllVTables();
+    }, [this](const QList<VTableDescription> &vtables) {
+        model->beginResetModel();
+        this->vtables = vtables;
+        model->endResetModel();
 
-    qhelpers::adjustColumns(ui->vTableTreeView, 3, 0);
+        qhelpers::adjustColumns(ui->vTableTreeView, 3, 0);
 
-    ui->vTableTreeView->setColumnWidth(0, 200);
+        ui->vTableTreeView->setColumnWidth(0, 200);
 
-    tree->showItemsNumber(proxy->rowCount());
+        tree->showItemsNumber(proxy->rowCount());
+    });
 }
 
 void VTablesWidget::on_vTableTreeView_doubleClicked(const QModelIndex &index)
@@ -1,26 +1,21 @@
 #include "VisualNavbar.h"
 #include "core/MainWindow.h"
 #include "common/TempConfig.h"
+#include "common/BlockStatisticsEngine.h"
+#include "common/EntropyMapProvider.h"
 
-#include <QGraphicsView>
-#include <QComboBox>
-#include <QGraphicsScene>
-#include <QGraphicsRectItem>
-#include <QJsonDocument>
-#include <QJsonObject>
-#include <QJsonArray>
-#include <QJsonParseError>
+#include <QPainter>
 #include <QToolTip>
 #include <QMouseEvent>
+#include <QMenu>
+#include <QActionGroup>
 
-#include <array>
+#include <algorithm>
 #include <cmath>
 
 VisualNavbar::VisualNavbar(MainWindow *main, QWidget *parent) :
     QToolBar(main),
-    graphicsView(new QGraphicsView),
-    seekGraphicsItem(nullptr),
-    PCGraphicsItem(nullptr),
+    canvas(new QWidget),
     main(main)
 {
     Q_UNUSED(parent);
@@ -33,74 +28,37 @@ VisualNavbar::VisualNavbar(MainWindow *main, QWidget *parent) :
     // and the result is wrong. Something to do with overwriting the style sheet :/
     //setStyleSheet("QToolBar { border: 0px; border-bottom: 0px; border-top: 0px; border-width: 0px;}");
 
-    /*
-    QComboBox *addsCombo = new QComboBox();
-    addsCombo->addItem("");
-    addsCombo->addItem("Entry points");
-    addsCombo->addItem("Marks");
-    */
-    addWidget(this->graphicsView);
-    //addWidget(addsCombo);
+    addWidget(this->canvas);
 
     connect(Core(), SIGNAL(seekChanged(RVA)), this, SLOT(on_seekChanged(RVA)));
     connect(Core(), SIGNAL(registersChanged()), this, SLOT(drawPCCursor()));
-    connect(Core(), SIGNAL(refreshAll()), this, SLOT(fetchAndPaintData()));
-    connect(Core(), SIGNAL(functionsChanged()), this, SLOT(fetchAndPaintData()));
-    connect(Core(), SIGNAL(flagsChanged()), this, SLOT(fetchAndPaintData()));
-
-    graphicsScene = new QGraphicsScene(this);
-
-    const QBrush bg = QBrush(QColor(74, 74, 74));
-
-    graphicsScene->setBackgroundBrush(bg);
-
-    this->graphicsView->setAlignment(Qt::AlignLeft);
-    this->graphicsView->setMinimumHeight(15);
-    this->graphicsView->setMaximumHeight(15);
-    this->graphicsView->setFrameShape(QFrame::NoFrame);
-    this->graphicsView->setRenderHints(0);
-    this->graphicsView->setScene(graphicsScene);
-    this->graphicsView->setRenderHints(QPainter::Antialiasing);
-    this->graphicsView->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-    this->graphicsView->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-    // So the graphicsView doesn't intercept mouse events.
-    this->graphicsView->setEnabled(false);
-    this->graphicsView->setMouseTracking(true);
+    // The statistics engine already follows refreshAll, functionsChanged and flagsChanged
+    connect(Core()->getBlockStatisticsEngine(), &BlockStatisticsEngine::statisticsChanged,
+            this, &VisualNavbar::fetchAndPaintData);
+    connect(Core()->getEntropyMapProvider(), &EntropyMapProvider::mapChanged,
+            this, &VisualNavbar::entropyMapChanged);
+
+    this->canvas->setMinimumHeight(15);
+    this->canvas->setMaximumHeight(15);
+    this->canvas->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
+    // So the canvas doesn't intercept mouse events.
+    this->canvas->setAttribute(Qt::WA_TransparentForMouseEvents);
+    this->canvas->setAttribute(Qt::WA_OpaquePaintEvent);
+    this->canvas->installEventFilter(this);
     setMouseTracking(true);
 }
 
-unsigned int nextPow2(unsigned int n)
+bool VisualNavbar::eventFilter(QObject *watched, QEvent *event)
 {
-    unsigned int b = 0;
-    while (n) {
-        n >>= 1;
-        b++;
-    }
-    return (1u << b);
-}
-
-void VisualNavbar::paintEvent(QPaintEvent *event)
-{
-    Q_UNUSED(event);
-
-    QPainter painter(this);
-
-    auto w = static_cast<unsigned int>(width());
-    bool fetch = false;
-    if (statsWidth < w) {
-        statsWidth = nextPow2(w);
-        fetch = true;
-    } else if (statsWidth > w * 4) {
-        statsWidth = statsWidth > 0 ? statsWidth / 2 : 0;
-        fetch = true;
-    }
-
-    if (fetch) {
-        fetchAndPaintData();
-    } else if (previousWidth != w) {
-        this->previousWidth = w;
-        updateGraphicsScene();
+    if (watched == canvas) {
+        if (event->type() == QEvent::Paint) {
+            paintCanvas();
+            return true;
+        } else if (event->type() == QEvent::Resize) {
+            fetchAndPaintData();
+        }
     }
+    return QToolBar::eventFilter(watched, event);
 }
 
 void VisualNavbar::fetchAndPaintData()
@@ -111,131 +69,115 @@ void VisualNavbar::fetchAndPaintData()
 
 void VisualNavbar::fetchStats()
 {
-    stats = Core()->getBlockStatistics(statsWidth);
+    // Resampling is done from the cached statistics, no need to round to bigger sizes anymore
+    statsWidth = canvas->width();
+    stats = Core()->getBlockStatistics(static_cast<unsigned int>(qMax(statsWidth, 0)));
 }
 
-enum class DataType : int { Empty, Code, String, Symbol, Count };
-
 void VisualNavbar::updateGraphicsScene()
 {
-    graphicsScene->clear();
-    xToAddress.clear();
-    seekGraphicsItem = nullptr;
-    PCGraphicsItem = nullptr;
-    graphicsScene->setBackgroundBrush(QBrush(Config()->getColor("gui.navbar.empty")));
+    NavbarRasterTask::Colors colors;
+    colors.empty = Config()->getColor("gui.navbar.empty");
+    colors.code = Config()->getColor("gui.navbar.code");
+    colors.string = Config()->getColor("gui.navbar.str");
+    colors.symbol = Config()->getColor("gui.navbar.sym");
+
+    rasterTask = QSharedPointer<NavbarRasterTask>(new NavbarRasterTask(stats, canvas->width(),
+                                                                       canvas->height(), colors));
+    rasterTask->setSupersedeKey(this, QStringLiteral("raster"));
+    if (mode != NavbarRasterTask::Mode::DataTypes) {
+        rasterTask->setHeatmap(mode, Core()->getEntropyMapProvider()->getMap());
+    }
+    // Results of a superseded task are dropped in rasterFinished
+    connect(rasterTask.data(), &NavbarRasterTask::rasterFinished, this, &VisualNavbar::rasterFinished);
+    Core()->getAsyncTaskManager()->start(rasterTask);
+}
 
-    if (stats.to <= stats.from) {
+void VisualNavbar::rasterFinished(const QImage &image, const QVector<RVA> &columnAddresses)
+{
+    if (sender() != rasterTask.data()) {
         return;
     }
+    this->image = image;
+    this->columnAddresses = columnAddresses;
+    canvas->update();
+}
 
-    int w = graphicsView->width();
-    int h = graphicsView->height();
+void VisualNavbar::entropyMapChanged()
+{
+    if (mode != NavbarRasterTask::Mode::DataTypes) {
+        updateGraphicsScene();
+    }
+}
 
-    RVA totalSize = stats.to - stats.from;
-    RVA beginAddr = stats.from;
+void VisualNavbar::setMode(NavbarRasterTask::Mode mode)
+{
+    this->mode = mode;
+    if (mode != NavbarRasterTask::Mode::DataTypes) {
+        // Does nothing if the map is already there or being computed
+        Core()->getEntropyMapProvider()->request();
+    }
+    updateGraphicsScene();
+}
 
-    double widthPerByte = (double)w / (double)totalSize;
-    auto xFromAddr = [widthPerByte, beginAddr] (RVA addr) -> double {
-        return (addr - beginAddr) * widthPerByte;
+void VisualNavbar::contextMenuEvent(QContextMenuEvent *event)
+{
+    QMenu menu(this);
+    auto *group = new QActionGroup(&menu);
+    auto addModeAction = [&](const QString &text, NavbarRasterTask::Mode actionMode) {
+        QAction *action = menu.addAction(text);
+        action->setCheckable(true);
+        action->setChecked(mode == actionMode);
+        action->setActionGroup(group);
+        connect(action, &QAction::triggered, this, [this, actionMode]() {
+            setMode(actionMode);
+        });
     };
+    addModeAction(tr("Show data types"), NavbarRasterTask::Mode::DataTypes);
+    addModeAction(tr("Show entropy"), NavbarRasterTask::Mode::Entropy);
+    addModeAction(tr("Show byte classes"), NavbarRasterTask::Mode::ByteClasses);
+    menu.exec(event->globalPos());
+}
 
-    std::array<QBrush, static_cast<int>(DataType::Count)> dataTypeBrushes;
-    dataTypeBrushes[static_cast<int>(DataType::Code)] = QBrush(Config()->getColor("gui.navbar.code"));
-    dataTypeBrushes[static_cast<int>(DataType::String)] = QBrush(Config()->getColor("gui.navbar.str"));
-    dataTypeBrushes[static_cast<int>(DataType::Symbol)] = QBrush(Config()->getColor("gui.navbar.sym"));
-
-    DataType lastDataType = DataType::Empty;
-    QGraphicsRectItem *dataItem = nullptr;
-    QRectF dataItemRect(0.0, 0.0, 0.0, h);
-    for (const BlockDescription &block : stats.blocks) {
-        // Keep track of where which memory segment is mapped so we are able to convert from
-        // address to X coordinate and vice versa.
-        XToAddress x2a;
-        x2a.x_start = xFromAddr(block.addr);
-        x2a.x_end = xFromAddr(block.addr + block.size);
-        x2a.address_from = block.addr;
-        x2a.address_to = block.addr + block.size;
-        xToAddress.append(x2a);
-
-        DataType dataType;
-        if (block.functions > 0) {
-            dataType = DataType::Code;
-        } else if (block.strings > 0) {
-            dataType = DataType::String;
-        } else if (block.symbols > 0) {
-            dataType = DataType::Symbol;
-        } else if (block.inFunctions > 0) {
-            dataType = DataType::Code;
-        } else {
-            lastDataType = DataType::Empty;
-            continue;
-        }
-
-        if (dataType == lastDataType) {
-            double r = xFromAddr(block.addr + block.size);
-            if (r > dataItemRect.right()) {
-                dataItemRect.setRight(r);
-                dataItem->setRect(dataItemRect);
-            }
-            dataItem->setRect(dataItemRect);
-            continue;
-        }
-
-        dataItemRect.setX(xFromAddr(block.addr));
-        dataItemRect.setRight(xFromAddr(block.addr + block.size));
-
-        dataItem = new QGraphicsRectItem();
-        dataItem->setPen(Qt::NoPen);
-        dataItem->setBrush(dataTypeBrushes[static_cast<int>(dataType)]);
-        graphicsScene->addItem(dataItem);
-
-        lastDataType = dataType;
+void VisualNavbar::paintCanvas()
+{
+    QPainter painter(canvas);
+    if (image.isNull()) {
+        painter.fillRect(canvas->rect(), Config()->getColor("gui.navbar.empty"));
+    } else {
+        // Until the new image arrives after a resize, stretch the previous one
+        painter.drawImage(canvas->rect(), image);
     }
 
-    // Update scene width
-    graphicsScene->setSceneRect(0, 0, w, h);
-
-    drawSeekCursor();
+    drawCursor(painter, Core()->getOffset(), Config()->getColor("gui.navbar.seek"));
+    drawCursor(painter, pcAddress, Config()->getColor("gui.navbar.pc"));
 }
 
-void VisualNavbar::drawCursor(RVA addr, QColor color, QGraphicsRectItem *&graphicsItem)
+void VisualNavbar::drawCursor(QPainter &painter, RVA addr, const QColor &color)
 {
     double cursor_x = addressToLocalX(addr);
-    if (graphicsItem != nullptr) {
-        graphicsScene->removeItem(graphicsItem);
-        delete graphicsItem;
-        graphicsItem = nullptr;
-    }
     if (std::isnan(cursor_x)) {
         return;
     }
-    int h = this->graphicsView->height();
-    graphicsItem = new QGraphicsRectItem(cursor_x, 0, 2, h);
-    graphicsItem->setPen(Qt::NoPen);
-    graphicsItem->setBrush(QBrush(color));
-    graphicsScene->addItem(graphicsItem);
+    painter.fillRect(QRectF(cursor_x, 0, 2, canvas->height()), color);
 }
 
 void VisualNavbar::drawPCCursor()
 {
-    drawCursor(Core()->getProgramCounterValue(), Config()->getColor("gui.navbar.pc"), PCGraphicsItem);
-}
-
-void VisualNavbar::drawSeekCursor()
-{
-    drawCursor(Core()->getOffset(), Config()->getColor("gui.navbar.seek"), seekGraphicsItem);
+    pcAddress = Core()->getProgramCounterValue();
+    canvas->update();
 }
 
 void VisualNavbar::on_seekChanged(RVA addr)
 {
     Q_UNUSED(addr);
     // Update cursor
-    this->drawSeekCursor();
+    canvas->update();
 }
 
 void VisualNavbar::mousePressEvent(QMouseEvent *event)
 {
-    qreal x = event->localPos().x();
+    qreal x = canvas->mapFrom(this, event->pos()).x();
     RVA address = localXToAddress(x);
     if (address != RVA_INVALID) {
         QToolTip::showText(event->globalPos(), toolTipForAddress(address), this);
@@ -254,26 +196,32 @@ void VisualNavbar::mouseMoveEvent(QMouseEvent *event)
 
 RVA VisualNavbar::localXToAddress(double x)
 {
-    for (const XToAddress &x2a : xToAddress) {
-        if ((x2a.x_start <= x) && (x <= x2a.x_end)) {
-            double offset = (x - x2a.x_start) / (x2a.x_end - x2a.x_start);
-            double size = x2a.address_to - x2a.address_from;
-            return x2a.address_from + (offset * size);
-        }
+    if (columnAddresses.size() < 2 || image.width() <= 0) {
+        return RVA_INVALID;
+    }
+    // The image may be stretched to the canvas until a new one is rendered
+    double column = x * image.width() / qMax(canvas->width(), 1);
+    int col = static_cast<int>(std::floor(column));
+    if (col < 0 || col >= columnAddresses.size() - 1) {
+        return RVA_INVALID;
     }
-    return RVA_INVALID;
+    RVA start = columnAddresses[col];
+    RVA end = columnAddresses[col + 1];
+    return start + static_cast<RVA>((column - col) * (end - start));
 }
 
 double VisualNavbar::addressToLocalX(RVA address)
 {
-    for (const XToAddress &x2a : xToAddress) {
-        if ((x2a.address_from <= address) && (address < x2a.address_to)) {
-            double offset = (double)(address - x2a.address_from) / (double)(x2a.address_to - x2a.address_from);
-            double size = x2a.x_end - x2a.x_start;
-            return x2a.x_start + (offset * size);
-        }
+    if (columnAddresses.size() < 2 || address < columnAddresses.first()
+            || address >= columnAddresses.last()) {
+        return nan("");
     }
-    return nan("");
+    auto it = std::upper_bound(columnAddresses.constBegin(), columnAddresses.constEnd(), address);
+    int col = static_cast<int>(it - columnAddresses.constBegin()) - 1;
+    RVA start = columnAddresses[col];
+    RVA end = columnAddresses[col + 1];
+    double offset = end > start ? (double)(address - start) / (double)(end - start) : 0.0;
+    return (col + offset) * canvas->width() / image.width();
 }
 
 QList<QString> VisualNavbar::sectionsForAddress(RVA address)
@@ -291,6 +239,19 @@ QList<QString> VisualNavbar::sectionsForAddress(RVA address)
 QString VisualNavbar::toolTipForAddress(RVA address)
 {
     QString ret = "Address: " + RAddressString(address);
+    if (mode != NavbarRasterTask::Mode::DataTypes) {
+        const EntropyMap &entropy = Core()->getEntropyMapProvider()->getMap();
+        if (!entropy.isEmpty()) {
+            EntropyBucket bucket = entropy.average(address, address + 1);
+            ret += QString("\nEntropy: %1").arg(bucket.entropy, 0, 'f', 2);
+            if (mode == NavbarRasterTask::Mode::ByteClasses) {
+                ret += QString("\nZeros: %1%\nPrintable: %2%\nHigh: %3%")
+                       .arg(qRound(bucket.zeros * 100))
+                       .arg(qRound(bucket.printable * 100))
+                       .arg(qRound(bucket.high * 100));
+            }
+        }
+    }
     auto sections = sectionsForAddress(address);
     if (sections.count()) {
         ret += "\nSections: \n";
@@ -2,51 +2,55 @@
 #define VISUALNAVBAR_H
 
 #include <QToolBar>
-#include <QGraphicsScene>
+#include <QImage>
+#include <QVector>
 
 #include "core/Cutter.h"
+#include "common/NavbarRasterTask.h"
 
 class MainWindow;
-class QGraphicsView;
 
 class VisualNavbar : public QToolBar
 {
     Q_OBJECT
 
-    struct XToAddress {
-        double x_start;
-        double x_end;
-        RVA address_from;
-        RVA address_to;
-    };
-
 public:
     explicit VisualNavbar(MainWindow *main, QWidget *parent = nullptr);
 
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
 public slots:
-    void paintEvent(QPaintEvent *event) override;
     void updateGraphicsScene();
 
 private slots:
     void fetchAndPaintData();
     void fetchStats();
-    void drawSeekCursor();
     void drawPCCursor();
-    void drawCursor(RVA addr, QColor color, QGraphicsRectItem *&graphicsItem);
     void on_seekChanged(RVA addr);
+    void rasterFinished(const QImage &image, const QVector<RVA> &columnAddresses);
+    void entropyMapChanged();
 
 private:
-    QGraphicsView     *graphicsView;
-    QGraphicsScene    *graphicsScene;
-    QGraphicsRectItem *seekGraphicsItem;
-    QGraphicsRectItem *PCGraphicsItem;
+    QWidget           *canvas;
     MainWindow        *main;
 
     BlockStatistics    stats;
-    unsigned int       statsWidth = 0;
-    unsigned int       previousWidth = 0;
+    int                statsWidth = 0;
+
+    QSharedPointer<NavbarRasterTask> rasterTask;
+    QImage             image;
+    /**
+     * Start address of each pixel column of image, plus the end address of the last one.
+     */
+    QVector<RVA>       columnAddresses;
+
+    RVA                pcAddress = RVA_INVALID;
+
+    NavbarRasterTask::Mode mode = NavbarRasterTask::Mode::DataTypes;
+    void setMode(NavbarRasterTask::Mode mode);
 
-    QList<XToAddress> xToAddress;
+    void paintCanvas();
+    void drawCursor(QPainter &painter, RVA addr, const QColor &color);
 
     RVA localXToAddress(double x);
     double addressToLocalX(RVA address);
@@ -55,6 +59,7 @@ private:
 
     void mousePressEvent(QMouseEvent *event) override;
     void mouseMoveEvent(QMouseEvent *event) override;
+    void contextMenuEvent(QContextMenuEvent *event) override;
 };
 
 #endif // VISUALNAVBAR_H
@@ -2,6 +2,7 @@
 #include "ui_ZignaturesWidget.h"
 #include "core/MainWindow.h"
 #include "common/Helpers.h"
+#include "common/RefreshScheduler.h"
 
 ZignaturesModel::ZignaturesModel(QList<ZignatureDescription> *zignatures, QObject *parent)
     : QAbstractListModel(parent),
@@ -133,13 +134,17 @@ ZignaturesWidget::~ZignaturesWidget() {}
 
 void ZignaturesWidget::refreshZignatures()
 {
-    zignaturesModel->beginResetModel();
-    zignatures = Core()->getAllZignatures();
-    zignaturesModel->endResetModel();
-
-    ui->zignaturesTreeView->resizeColumnToContents(0);
-    ui->zignaturesTreeView->resizeColumnToContents(1);
-    ui->zignaturesTreeView->resizeColumnToContents(2);
+    Core()->getRefreshScheduler()->schedule<QList<ZignatureDescription>>(this, []() {
+        return Core()->getAllZignatures();
+    }, [this](const QList<ZignatureDescription> &zignatures) {
+        zignaturesModel->beginResetModel();
+        this->zignatures = zignatures;
+        zignaturesModel->endResetModel();
+
+        ui->zignaturesTreeView->resizeColumnToContents(0);
+        ui->zignaturesTreeView->resizeColumnToContents(1);
+        ui->zignaturesTreeView->resizeColumnToContents(2);
+    });
 }
 
 void ZignaturesWidget::setScrollMode()